@@ -1,10 +1,12 @@
 #include <iostream>
+#include <atomic>
 #include <cstdio>
 #include <cstdlib>
 #include <cstdint>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/shm.h>
+#include <unistd.h>
 #include "alloc.h"
 #include "thread.h"
 
@@ -79,13 +81,13 @@ void alloc::shared_free_impl(uint32_t key) {
 	}
 }
 
-std::pair<void *, int> alloc::mmap_file_impl(size_t n, const std::string &path) {
-	int fd = open(path.c_str(), O_RDWR);
+std::pair<void *, int> alloc::mmap_file_impl(size_t n, const std::string &path, bool readonly) {
+	int fd = open(path.c_str(), readonly ? O_RDONLY : O_RDWR);
 	if (fd == -1) {
 		return std::make_pair((void *) NULL, -1);
 	}
 
-	int prot = PROT_READ | PROT_WRITE;
+	int prot = readonly ? PROT_READ : (PROT_READ | PROT_WRITE);
 	int flags = MAP_SHARED;
 	void *mem = mmap(NULL, n, prot, flags, fd, 0);
 
@@ -96,3 +98,42 @@ std::pair<void *, int> alloc::mmap_file_impl(size_t n, const std::string &path)
 
 	return std::make_pair(mem, fd);
 }
+
+std::pair<void *, int> alloc::huge_file_impl(size_t n, const std::string &path, size_t offset) {
+	int fd = open(path.c_str(), O_RDWR);
+	if (fd == -1) {
+		return std::make_pair((void *) NULL, -1);
+	}
+
+	int prot = PROT_READ | PROT_WRITE;
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (PAGE_SIZE << MAP_HUGE_SHIFT);
+	void *mem = mmap(NULL, num_pages(n) << PAGE_SIZE, prot, flags, -1, 0);
+	if (mem == MAP_FAILED) {
+		perror("mmap");
+		abort();
+	}
+
+	// one chunk at a time per worker; the pages are faulted in by the reads
+	constexpr size_t CHUNK = 64LL << 20;
+	std::atomic<size_t> next = 0;
+	std::atomic<bool> failed = false;
+
+	parallel workers([&](size_t id) {
+		size_t start;
+		while ((start = next.fetch_add(CHUNK)) < n) {
+			size_t len = std::min(CHUNK, n - start);
+			if (pread(fd, (char *) mem + start, len, offset + start) != len) {
+				failed = true;
+			}
+		}
+	});
+
+	workers.join();
+
+	if (failed) {
+		perror("pread");
+		abort();
+	}
+
+	return std::make_pair(mem, fd);
+}
@@ -2,7 +2,7 @@
 #define INVL_ALLOC_H
 
 class alloc {
-	static constexpr size_t ALLOC_GB = 3;
+	static constexpr size_t ALLOC_GB = 2;
 
     public:
 	template<typename T>
@@ -20,8 +20,15 @@ class alloc {
 	}
 
 	template<typename T>
-	static std::pair<T *, int> mmap_file(size_t n, const std::string &path) {
-		auto [ mem, fd ] = mmap_file_impl(n * sizeof(T), path);
+	static std::pair<T *, int> mmap_file(size_t n, const std::string &path, bool readonly = false) {
+		auto [ mem, fd ] = mmap_file_impl(n * sizeof(T), path, readonly);
+		return std::make_pair((T *) mem, fd);
+	}
+
+	// anonymous 1 GB hugepage copy of n bytes of a file, starting at offset
+	template<typename T>
+	static std::pair<T *, int> huge_file(size_t n, const std::string &path, size_t offset) {
+		auto [ mem, fd ] = huge_file_impl(n * sizeof(T), path, offset);
 		return std::make_pair((T *) mem, fd);
 	}
 
@@ -29,7 +36,8 @@ class alloc {
 	static void * huge_impl(size_t n);
 	static void * shared_impl(size_t n, uint32_t key);
 	static void shared_free_impl(uint32_t key);
-	static std::pair<void *, int> mmap_file_impl(size_t n, const std::string &path);
+	static std::pair<void *, int> mmap_file_impl(size_t n, const std::string &path, bool readonly);
+	static std::pair<void *, int> huge_file_impl(size_t n, const std::string &path, size_t offset);
 };
 
 #endif
@@ -0,0 +1,201 @@
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "archive.h"
+#include "thread.h"
+#include "alloc.h"
+
+namespace {
+	struct decoded {
+		uint8_t len;
+		uint8_t moves[MAX_DEPTH];
+
+		bool operator < (const decoded &o) const {
+			return std::lexicographical_compare(moves, moves + len, o.moves, o.moves + o.len);
+		}
+	};
+
+	struct nibble_writer {
+		std::vector<uint8_t> &out;
+		bool odd = false;
+
+		void put(int n) {
+			if (odd) {
+				out.back() |= n;
+			} else {
+				out.push_back(n << 4);
+			}
+			odd = !odd;
+		}
+	};
+}
+
+// appends the sorted, prefix coded solutions of a coset to out
+static void encode(std::span<const tracker::solution> solutions, std::vector<decoded> &sorted,
+		std::vector<uint8_t> &out) {
+	sorted.resize(solutions.size());
+	for (size_t i = 0; i < solutions.size(); i++) {
+		sorted[i].len = solutions[i].decode(sorted[i].moves);
+	}
+	std::sort(sorted.begin(), sorted.end());
+
+	nibble_writer w{out};
+	const decoded *prev = NULL;
+	for (auto &s : sorted) {
+		int len = 0;
+		if (prev) {
+			while (len < 15 && len < s.len && len < prev->len && s.moves[len] == prev->moves[len]) {
+				len++;
+			}
+		}
+		int rest = s.len - len;
+		w.put(len);
+		if (rest >= 15) {
+			w.put(15);
+			w.put(rest - 15);
+		} else {
+			w.put(rest);
+		}
+		for (int i = len; i < s.len; i++) {
+			int m = s.moves[i];
+			if (i == 0) {
+				w.put(m >> 4);
+				w.put(m & 0xf);
+			} else {
+				w.put(s.moves[i - 1] < m ? m - 3 : m);
+			}
+		}
+		prev = &s;
+	}
+}
+
+bool archive::write(const std::string &path) {
+	std::vector<tracker::header> head(N_EDGE_INVO);
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		head[idx] = tracker::get_header(idx);
+	}
+
+	// cosets are encoded in parallel chunks and appended in order
+	constexpr size_t CHUNK_COSETS = 64;
+	constexpr size_t N_CHUNKS = (N_EDGE_INVO + CHUNK_COSETS - 1) / CHUNK_COSETS;
+
+	auto tmp = path + ".tmp";
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1) {
+		perror(tmp.c_str());
+		return false;
+	}
+
+	std::vector<uint64_t> offsets(N_EDGE_INVO + 1);
+	size_t data_offset = sizeof(file_header) + N_EDGE_INVO * sizeof(tracker::header) +
+		offsets.size() * sizeof(uint64_t);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	size_t next_chunk = 0, output_chunk = 0, size = 0;
+	bool failed = false;
+
+	parallel workers([&](size_t id) {
+		std::vector<decoded> sorted;
+		std::vector<uint8_t> out;
+		std::vector<uint64_t> sizes(CHUNK_COSETS);
+
+		std::unique_lock lock(mtx);
+		while (next_chunk < N_CHUNKS && !failed) {
+			size_t chunk = next_chunk++;
+			lock.unlock();
+
+			size_t start = chunk * CHUNK_COSETS;
+			size_t end = std::min<size_t>(start + CHUNK_COSETS, N_EDGE_INVO);
+			out.clear();
+			for (size_t idx = start; idx < end; idx++) {
+				size_t before = out.size();
+				encode(tracker::solutions(idx), sorted, out);
+				sizes[idx - start] = out.size() - before;
+			}
+
+			lock.lock();
+			cv.wait(lock, [&] { return output_chunk == chunk; });
+			for (size_t idx = start; idx < end; idx++) {
+				offsets[idx] = size;
+				size += sizes[idx - start];
+			}
+			size_t offset = data_offset + offsets[start];
+			lock.unlock();
+
+			bool ok = pwrite(fd, out.data(), out.size(), offset) == out.size();
+			if (!ok) {
+				perror(tmp.c_str());
+			}
+
+			lock.lock();
+			failed |= !ok;
+			output_chunk++;
+			cv.notify_all();
+		}
+	});
+
+	workers.join();
+
+	offsets[N_EDGE_INVO] = size;
+
+	size_t n_solutions = 0;
+	for (auto &h : head) {
+		n_solutions += h.n_solved;
+	}
+
+	file_header fh = { MAGIC, N_EDGE_INVO, n_solutions, size };
+	size_t head_offset = sizeof(fh);
+	size_t offsets_offset = head_offset + N_EDGE_INVO * sizeof(tracker::header);
+
+	bool ok = !failed &&
+		pwrite(fd, &fh, sizeof(fh), 0) == sizeof(fh) &&
+		pwrite(fd, &head[0], N_EDGE_INVO * sizeof(tracker::header), head_offset) ==
+			N_EDGE_INVO * sizeof(tracker::header) &&
+		pwrite(fd, &offsets[0], offsets.size() * sizeof(uint64_t), offsets_offset) ==
+			offsets.size() * sizeof(uint64_t) &&
+		fdatasync(fd) == 0;
+	::close(fd);
+
+	std::error_code ec;
+	if (ok) {
+		std::filesystem::rename(tmp, path, ec);
+	} else {
+		std::filesystem::remove(tmp, ec);
+	}
+	return ok && !ec;
+}
+
+bool archive::open(const std::string &path) {
+	std::error_code ec;
+	size_t file_size = std::filesystem::file_size(path, ec);
+	if (ec || file_size < sizeof(file_header)) {
+		return false;
+	}
+
+	auto [ mem, fd ] = alloc::mmap_file<uint8_t>(file_size, path, true);
+	if (!mem) {
+		return false;
+	}
+
+	::close(fd);
+
+	h = (const file_header *) mem;
+	head = (const tracker::header *) &h[1];
+	offsets = (const uint64_t *) &head[N_EDGE_INVO];
+	data = (const uint8_t *) &offsets[N_EDGE_INVO + 1];
+
+	size_t expect = (data - mem) + h->size;
+	if (h->magic != MAGIC || h->n_cosets != N_EDGE_INVO || expect != file_size ||
+			offsets[N_EDGE_INVO] != h->size) {
+		std::cerr << "invalid archive " << path << "\n";
+		munmap(mem, file_size);
+		h = NULL;
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,94 @@
+#ifndef INVL_ARCHIVE_H
+#define INVL_ARCHIVE_H
+
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <string>
+#include "tracker.h"
+
+// compact copy of the database for backups and exports
+// - file header, coset headers as in invo.dat, then the byte offset of
+//   each coset's data, N_EDGE_INVO + 1 entries
+// - a coset's solutions are sorted and stored as a stream of 4-bit codes:
+//   the length of the prefix shared with the previous solution (at most
+//   15), the number of remaining moves (15 escapes to 15 + next code),
+//   then the remaining moves, coded as in tracker::solution except that
+//   a first move takes two codes
+
+class archive {
+	static constexpr uint64_t MAGIC = 0x3176696863726120;
+
+	struct file_header {
+		uint64_t magic;
+		uint64_t n_cosets;
+		uint64_t n_solutions;
+		uint64_t size;
+	};
+
+	struct nibbles {
+		const uint8_t *p;
+		bool odd = false;
+
+		int next() {
+			int n = odd ? (*p++ & 0xf) : (*p >> 4);
+			odd = !odd;
+			return n;
+		}
+	};
+
+    public:
+	// needs an open tracker
+	static bool write(const std::string &path);
+
+	bool open(const std::string &path);
+
+	std::span<const tracker::header> headers() const {
+		return { head, N_EDGE_INVO };
+	}
+
+	size_t size() const {
+		return h->n_solutions;
+	}
+
+	// calls fn(const uint8_t *moves, int length) for each solution of a
+	// coset, in sorted order
+	template<typename F>
+	void for_each(int idx, F fn) const {
+		nibbles in{&data[offsets[idx]]};
+		uint8_t moves[MAX_DEPTH];
+		for (int n = head[idx].n_solved; n > 0; n--) {
+			int len = in.next();
+			int rest = in.next();
+			if (rest == 15) {
+				rest += in.next();
+			}
+			if (len + rest > MAX_DEPTH) {
+				std::cerr << "corrupt archive" << std::endl;
+				abort();
+			}
+			for (int i = len; i < len + rest; i++) {
+				if (i == 0) {
+					moves[0] = in.next() << 4;
+					moves[0] |= in.next();
+				} else {
+					int m = in.next();
+					if (moves[i - 1] / 3 <= m / 3) {
+						m += 3;
+					}
+					moves[i] = m;
+				}
+			}
+			len += rest;
+			fn(moves, len);
+		}
+	}
+
+    private:
+	const file_header *h = NULL;
+	const tracker::header *head = NULL;
+	const uint64_t *offsets = NULL;
+	const uint8_t *data = NULL;
+};
+
+#endif
@@ -4,10 +4,17 @@
 #include <cstdint>
 #include "ccoord.h"
 
-// perfect hash of raw 64-bit corners -> 65536 buckets
+// dense rank of corner involutions
 // - only valid for involutions
 // - even or odd parity, but not both
+// - 10396 even and 11424 odd states, rounded up to whole 64-bit words
+
+constexpr size_t N_CORNER_HASH = 11456;
+
+void corner_hash_init();
 
 uint16_t corner_hash(ccoord cc);
+uint16_t corner_hash(const cube &c);
+void corner_hash(const cube *c, size_t n, uint16_t *out);
 
 #endif
@@ -0,0 +1,108 @@
+#include <cstring>
+#include "corner_set.h"
+
+corner_set & corner_set::operator = (const corner_set &o) {
+	if (this == &o) {
+		return *this;
+	}
+	if (o.dense) {
+		if (!dense) {
+			dense = std::make_unique_for_overwrite<uint64_t[]>(N_WORDS);
+		}
+		memcpy(dense.get(), o.dense.get(), N_WORDS * sizeof(uint64_t));
+		sparse = {};
+	} else {
+		dense.reset();
+		sparse = o.sparse;
+	}
+	n = o.n;
+	return *this;
+}
+
+corner_set corner_set::from_words(const uint64_t *words) {
+	corner_set cs;
+	cs.dense = std::make_unique_for_overwrite<uint64_t[]>(N_WORDS);
+	memcpy(cs.dense.get(), words, N_WORDS * sizeof(uint64_t));
+	for (size_t i = 0; i < N_WORDS; i++) {
+		cs.n += std::popcount(cs.dense[i]);
+	}
+	if (cs.n < SPARSE_MAX) {
+		cs.make_sparse();
+	}
+	return cs;
+}
+
+corner_set corner_set::from_sorted(const uint16_t *hashes, size_t n) {
+	corner_set cs;
+	if (n < SPARSE_MAX) {
+		cs.sparse.assign(hashes, hashes + n);
+		cs.n = n;
+	} else {
+		cs.dense = std::make_unique<uint64_t[]>(N_WORDS);
+		for (size_t i = 0; i < n; i++) {
+			cs.set(hashes[i]);
+		}
+	}
+	return cs;
+}
+
+void corner_set::set(uint16_t h) {
+	if (dense) {
+		uint64_t bit = 1ULL << (h % 64);
+		n += (dense[h / 64] & bit) == 0;
+		dense[h / 64] |= bit;
+		return;
+	}
+
+	auto it = std::lower_bound(sparse.begin(), sparse.end(), h);
+	if (it != sparse.end() && *it == h) {
+		return;
+	}
+	sparse.insert(it, h);
+	if (++n == SPARSE_MAX) {
+		make_dense();
+	}
+}
+
+bool corner_set::reset(uint16_t h) {
+	if (dense) {
+		uint64_t bit = 1ULL << (h % 64);
+		if ((dense[h / 64] & bit) == 0) {
+			return false;
+		}
+		dense[h / 64] &= ~bit;
+		// convert at half the limit so a set near it doesn't flip back and forth
+		if (--n < SPARSE_MAX / 2) {
+			make_sparse();
+		}
+		return true;
+	}
+
+	auto it = std::lower_bound(sparse.begin(), sparse.end(), h);
+	if (it == sparse.end() || *it != h) {
+		return false;
+	}
+	sparse.erase(it);
+	if (--n == 0) {
+		sparse = {};
+	}
+	return true;
+}
+
+void corner_set::make_dense() {
+	dense = std::make_unique<uint64_t[]>(N_WORDS);
+	for (auto h : sparse) {
+		dense[h / 64] |= 1ULL << (h % 64);
+	}
+	sparse = {};
+}
+
+void corner_set::make_sparse() {
+	std::vector<uint16_t> hashes;
+	hashes.reserve(n);
+	for_each([&](uint16_t h) {
+		hashes.push_back(h);
+	});
+	sparse = std::move(hashes);
+	dense.reset();
+}
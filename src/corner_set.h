@@ -0,0 +1,84 @@
+#ifndef INVL_CORNER_SET_H
+#define INVL_CORNER_SET_H
+
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <bit>
+#include "bits.h"
+#include "corner_hash.h"
+
+// set of corner hashes, e.g. the unsolved cubes of an edge coset
+// - empty, a sorted array of hashes, or a dense bitmap
+// - the array is used below SPARSE_MAX elements, where it is smaller than
+//   the bitmap, so memory follows the number of elements
+
+class corner_set {
+    public:
+	static constexpr size_t N_WORDS = N_CORNER_HASH / 64;
+	static constexpr size_t SPARSE_MAX = N_WORDS * sizeof(uint64_t) / sizeof(uint16_t);
+
+	corner_set() = default;
+	corner_set(corner_set &&) = default;
+	corner_set & operator = (corner_set &&) = default;
+
+	corner_set(const corner_set &o) {
+		*this = o;
+	}
+
+	corner_set & operator = (const corner_set &o);
+
+	static corner_set from_words(const uint64_t *words);
+	static corner_set from_sorted(const uint16_t *hashes, size_t n);
+
+	bool test(uint16_t h) const {
+		if (dense) {
+			return (dense[h / 64] >> (h % 64)) & 1;
+		}
+		return std::binary_search(sparse.begin(), sparse.end(), h);
+	}
+
+	void set(uint16_t h);
+
+	// true if h was in the set
+	bool reset(uint16_t h);
+
+	size_t count() const {
+		return n;
+	}
+
+	bool is_dense() const {
+		return dense != nullptr;
+	}
+
+	// N_WORDS words, only valid when dense
+	const uint64_t * words() const {
+		return dense.get();
+	}
+
+	template<typename F>
+	void for_each(F fn) const {
+		if (dense) {
+			for (size_t i = 0; i < N_WORDS; i++) {
+				for (auto b : bits(dense[i])) {
+					fn(uint16_t(i * 64 + b));
+				}
+			}
+		} else {
+			for (auto h : sparse) {
+				fn(h);
+			}
+		}
+	}
+
+    private:
+	void make_dense();
+	void make_sparse();
+
+	std::unique_ptr<uint64_t[]> dense;
+	std::vector<uint16_t> sparse;
+	uint32_t n = 0;
+};
+
+#endif
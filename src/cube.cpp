@@ -1,3 +1,4 @@
+#include <iostream>
 #include <numeric>
 #include "cube.h"
 #include "thread.h"
@@ -52,9 +53,22 @@ void cube::init() {
 }
 
 cube cube::from_moveseq(const moveseq &moves) {
+	return from_moves(moves.data(), moves.size());
+}
+
+cube cube::from_moves(const std::string &s) {
+	moveseq moves;
+	if (!moveseq::parse(s, moves)) {
+		std::cerr << "too many moves: " << s << std::endl;
+		abort();
+	}
+	return from_moveseq(moves);
+}
+
+cube cube::from_moves(const uint8_t *moves, int n) {
 	cube c;
-	for (auto m : moves) {
-		c = c.move(m);
+	for (int i = 0; i < n; i++) {
+		c = c.move(moves[i]);
 	}
 	return c;
 }
@@ -240,3 +254,20 @@ cube cube::setCorners(const cube::corner_array_t &corners) const {
 	std::iota(&a[8], &a[16], 8);
 	return set<1>(v, a);
 }
+
+cube::packed_t cube::pack() const {
+	packed_t p;
+	auto e = getEdges();
+	auto c = getCorners();
+	std::copy(e.begin(), e.end(), &p[0]);
+	std::copy(c.begin(), c.end(), &p[12]);
+	return p;
+}
+
+cube cube::unpack(const cube::packed_t &p) {
+	edge_array_t e;
+	corner_array_t c;
+	std::copy(&p[0], &p[12], e.begin());
+	std::copy(&p[12], &p[20], c.begin());
+	return cube{}.setEdges(e).setCorners(c);
+}
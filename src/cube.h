@@ -50,11 +50,14 @@ class cube {
 	}
 
 	static cube from_moveseq(const moveseq &);
+	static cube from_moves(const uint8_t *moves, int n);
 
-	static cube from_moves(const std::string &s) {
-		return from_moveseq(moveseq::parse(s));
+	static cube symmetry(int s) {
+		return syms[s];
 	}
 
+	static cube from_moves(const std::string &s);
+
 	std::string to_sing() const;
 
 	bool operator == (const cube &rhs) const {
@@ -105,6 +108,10 @@ class cube {
 
 	eperm_t getEdgePerm() const;
 
+	__m128i getEdgeVec() const {
+		return _mm256_castsi256_si128(v);
+	}
+
 	cperm_t getCornerPerm() const;
 
 	eorient_t getEdgeOrientRaw() const {
@@ -156,6 +163,11 @@ class cube {
 	using corner_array_t = std::array<uint8_t, 8>;
 	corner_array_t getCorners() const;
 	cube setCorners(const corner_array_t &) const;
+
+	// 20 bytes, the edges then the corners as in getEdges and getCorners
+	using packed_t = std::array<uint8_t, 20>;
+	packed_t pack() const;
+	static cube unpack(const packed_t &);
 };
 
 #endif
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <filesystem>
+#include <unistd.h>
+#include "ecindex.h"
+#include "thread.h"
+#include "tables.h"
+#include "alloc.h"
+
+std::vector<ecindex::entry> ecindex::build(const std::vector<ecoord> &cosets) {
+	std::vector<std::vector<entry>> partial(N_WORKERS);
+
+	parallel workers([&](size_t id) {
+		size_t block = cosets.size() / N_WORKERS;
+		size_t start = id * block, end = start + block;
+		if (id == N_WORKERS - 1) end = cosets.size();
+
+		auto &out = partial[id];
+		for (size_t idx = start; idx < end; idx++) {
+			cube edges = cosets[idx];
+			for (int s = 0; s < N_SYM48; s++) {
+				out.emplace_back(edges.symi(s), s, idx);
+			}
+		}
+	});
+
+	workers.join();
+
+	std::vector<entry> entries;
+	for (auto &out : partial) {
+		entries.insert(entries.end(), out.begin(), out.end());
+		out = {};
+	}
+	std::sort(entries.begin(), entries.end());
+
+	// keep the lowest symmetry for self-symmetric cosets
+	auto last = std::unique(entries.begin(), entries.end(),
+			[](const entry &a, const entry &b) { return a.same_key(b); });
+	entries.erase(last, entries.end());
+
+	return entries;
+}
+
+bool ecindex::create(const std::vector<ecoord> &cosets) {
+	auto entries = build(cosets);
+	file_header h = { MAGIC, entries.size() };
+	return tables::save(INDEX_FILE, h, &entries[0], entries.size());
+}
+
+bool ecindex::open() {
+	auto path = tables::full_path(INDEX_FILE);
+
+	std::error_code ec;
+	size_t file_size = std::filesystem::file_size(path, ec);
+	if (ec || file_size < sizeof(file_header)) {
+		return false;
+	}
+
+	auto [ mem, fd ] = alloc::mmap_file<uint8_t>(file_size, path, true);
+	if (!mem) {
+		return false;
+	}
+
+	::close(fd);
+
+	auto h = (const file_header *) mem;
+	if (h->magic != MAGIC || sizeof(*h) + h->size * sizeof(entry) != file_size) {
+		std::cerr << "invalid coset index " << path << "\n";
+		return false;
+	}
+
+	index = (const entry *) &h[1];
+	size = h->size;
+
+	return true;
+}
+
+std::pair<int, int> ecindex::lookup(const cube &c) {
+	entry key{ecoord{c}};
+	auto it = std::lower_bound(index, index + size, key);
+	if (it == index + size || !it->same_key(key)) {
+		return std::make_pair(-1, -1);
+	}
+	return std::make_pair(int(it->idx), int(it->sym));
+}
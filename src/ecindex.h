@@ -0,0 +1,59 @@
+#ifndef INVL_ECINDEX_H
+#define INVL_ECINDEX_H
+
+#include <cstdint>
+#include <vector>
+#include "ecoord.h"
+
+// coset lookup by edges, for every symmetry image of every edge coset
+// - sorted flat array keyed by ecoord, saved in tables/ and mapped read-only
+// - an image c of coset idx satisfies c == cube(coset).symi(sym)
+
+class ecindex {
+	static constexpr char INDEX_FILE[] = "invoIndex.dat";
+	static constexpr uint64_t MAGIC = 0x3178656469636527;
+
+    public:
+	struct entry {
+		uint32_t ep;
+		uint16_t eo;
+		uint8_t sym;
+		uint8_t _reserved;
+		uint32_t idx;
+
+		entry() : ep(), eo(), sym(), _reserved(), idx() {
+		}
+
+		entry(ecoord ec, int sym = 0, int idx = 0) : sym(sym), _reserved(), idx(idx) {
+			auto [ ep_idx, eo_ ] = ec.coord();
+			ep = ep_idx | (uint32_t(ec.sym()) << 24);
+			eo = eo_;
+		}
+
+		bool same_key(const entry &o) const {
+			return ep == o.ep && eo == o.eo;
+		}
+
+		bool operator < (const entry &o) const {
+			return std::tie(ep, eo, sym) < std::tie(o.ep, o.eo, o.sym);
+		}
+	};
+
+	static std::vector<entry> build(const std::vector<ecoord> &cosets);
+	static bool create(const std::vector<ecoord> &cosets);
+	static bool open();
+
+	// (coset index, sym), or (-1, -1) if the edges are not in any coset
+	static std::pair<int, int> lookup(const cube &c);
+
+    private:
+	struct file_header {
+		uint64_t magic;
+		uint64_t size;
+	};
+
+	inline static const entry *index = NULL;
+	inline static size_t size = 0;
+};
+
+#endif
@@ -52,6 +52,14 @@ class ecoord {
 		return ec;
 	}
 
+	ecoord move(int m, const eperm48::moves_t &row) const {
+		ecoord ec;
+		uint8_t s;
+		std::tie(ec.ep, m, s) = ep.move_ex(m, row);
+		ec.eo = eo.movei(m, s);
+		return ec;
+	}
+
 	int sym() const {
 		return ep.sym();
 	}
@@ -47,11 +47,9 @@ class ecsolver_impl {
 	int threshold = 0;
 
 	tracker::handle &handle;
-	bool parity;
 
     public:
 	ecsolver_impl(tracker::handle &handle) : seeds(SAFE_DEDUPE_DEPTH + 1), handle(handle) {
-		parity = handle.parity();
 		ec0 = handle.ec();
 
 		c0 = cube{ec0};
@@ -64,11 +62,10 @@ class ecsolver_impl {
 
 	void rebuild_cpr() {
 		std::vector<ccoord> unsolved;
-		for (auto cc : involution::corners()[parity]) {
-			if (handle.is_unsolved(cc)) {
-				unsolved.push_back(cc);
-			}
-		}
+		unsolved.reserve(handle.todo);
+		handle.for_each_unsolved([&](ccoord cc) {
+			unsolved.push_back(cc);
+		});
 		if (unsolved.size() != handle.todo) abort();
 
 		cpr.generate(unsolved);
@@ -177,9 +174,8 @@ class ecsolver_impl {
 					continue;
 				}
 
-				auto ec_m = ec.move(m);
+				auto [ ec_m, r_m ] = eprune::move(ec, m);
 				auto cc_m = cc.move(m);
-				auto r_m = eprune::lookup(ec_m);
 
 				moves.back() = m;
 
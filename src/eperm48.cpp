@@ -7,78 +7,218 @@
 using tables::load;
 using tables::save;
 
+// Edge permutations as byte vectors (orientation bits are ignored).
+// Symmetries are applied as a pair of byte shuffles, two symmetries
+// per 256-bit vector.  The shuffles also reverse the edge order and
+// clear the padding, so that packing nibble pairs leaves a 48-bit key
+// with the first edge most significant; key order is rank order.
+static __m256i sym_l[N_SYM48 / 2], sym_r[N_SYM48 / 2];
+static __m128i move_v[N_MOVES];
+
+static void init_vecs() {
+	union { __m256i v[N_SYM48 / 2]; uint8_t b[N_SYM48][16]; } l, r;
+
+	for (int s = 0; s < N_SYM48; s++) {
+		auto e = cube::symmetry(s).getEdges();
+		for (int i = 0; i < 16; i++) {
+			r.b[s][i] = (i < 12) ? e[11 - i] & 0xf : i;
+			l.b[s][i] = 0;
+		}
+		for (int i = 0; i < 12; i++) {
+			l.b[s][e[i] & 0xf] = i;
+		}
+	}
+
+	std::copy(&l.v[0], &l.v[N_SYM48 / 2], &sym_l[0]);
+	std::copy(&r.v[0], &r.v[N_SYM48 / 2], &sym_r[0]);
+
+	for (int m = 0; m < N_MOVES; m++) {
+		auto e = cube{}.move(m).getEdges();
+		for (auto &x : e) x &= 0xf;
+		move_v[m] = cube{}.setEdges(e).getEdgeVec();
+	}
+}
+
+static __m128i ep_move(__m128i v, int m) {
+	return _mm_shuffle_epi8(v, move_v[m]);
+}
+
+static __m128i ep_unrank(eperm_t ep) {
+	return cube{}.setEdgePerm(ep).getEdgeVec();
+}
+
+static eperm_t ep_rank(uint64_t key) {
+	uint64_t table = 0xba9876543210;
+	eperm_t eperm = 0;
+	for (int i = 0; i < 11; i++) {
+		int shift = ((key >> (44 - 4 * i)) & 0xf) * 4;
+		eperm = eperm * (12 - i) + _bextr_u64(table, shift, 4);
+		table -= 0x111111111110LL << shift;
+	}
+	return eperm;
+}
+
+// Keys of the symmetry images s and s + 1 (s even), one per lane
+static __m256i ep_keys(__m256i vv, int s) {
+	__m256i k = _mm256_shuffle_epi8(vv, sym_r[s / 2]);
+	k = _mm256_shuffle_epi8(sym_l[s / 2], k);
+	k = _mm256_maddubs_epi16(k, _mm256_set1_epi16(0x1001));
+	return _mm256_packus_epi16(k, _mm256_setzero_si256());
+}
+
+static void ep_keys(__m128i v, uint64_t *keys) {
+	__m256i vv = _mm256_broadcastsi128_si256(v);
+	for (int s = 0; s < N_SYM48; s += 2) {
+		__m256i k = ep_keys(vv, s);
+		keys[s] = _mm256_extract_epi64(k, 0);
+		keys[s + 1] = _mm256_extract_epi64(k, 2);
+	}
+}
+
+// Minimum key over all symmetries, and the first symmetry reaching it
+static std::pair<uint64_t, int> ep_min(__m128i v) {
+	__m256i vv = _mm256_broadcastsi128_si256(v);
+	__m256i vmin = _mm256_set1_epi64x(INT64_MAX);
+	__m256i vsym = _mm256_setzero_si256();
+	__m256i vs = _mm256_set_epi64x(0, 1, 0, 0);
+
+	for (int s = 0; s < N_SYM48; s += 2) {
+		__m256i k = ep_keys(vv, s);
+		__m256i lt = _mm256_cmpgt_epi64(vmin, k);
+		vmin = _mm256_blendv_epi8(vmin, k, lt);
+		vsym = _mm256_blendv_epi8(vsym, vs, lt);
+		vs = _mm256_add_epi64(vs, _mm256_set1_epi64x(2));
+	}
+
+	uint64_t k0 = _mm256_extract_epi64(vmin, 0), k1 = _mm256_extract_epi64(vmin, 2);
+	int s0 = _mm256_extract_epi64(vsym, 0), s1 = _mm256_extract_epi64(vsym, 2);
+	if (k1 < k0 || (k1 == k0 && s1 < s0)) {
+		return std::make_pair(k1, s1);
+	}
+	return std::make_pair(k0, s0);
+}
+
 void eperm48::init() {
 	static std::once_flag flag;
 	std::call_once(flag, [&]() {
 		cube::init();
 		sym::init();
+		init_vecs();
 
-		s2r = alloc::huge<eperm_t>(N_EPERM48);
-		moves = alloc::huge<moves_t>(N_EPERM48);
-		self = alloc::huge<uint64_t>(N_EPERM48);
+		// Keep the tables resident in shared memory so that later
+		// invocations (and concurrent processes) can skip the load
+		constexpr size_t SHM_SIZE =
+			N_EPERM48 * (sizeof(eperm_t) + sizeof(moves_t) + sizeof(uint64_t)) +
+			sizeof(MAGIC);
 
-		bool ok =
-			load(FNAME_S2R, s2r, N_EPERM48) &&
-			load(FNAME_MOVE, moves, N_EPERM48) &&
-			load(FNAME_SELF, self, N_EPERM48);
-		if (!ok) {
-			std::cerr << "generating eperm48 tables\n";
-			generate();
+		auto mem = alloc::shared<uint8_t>(SHM_SIZE, SHM_KEY);
+		if (!mem) {
+			std::cerr << "error getting shared memory for eperm48 tables\n";
+			abort();
+		}
+
+		s2r = (eperm_t *) mem;
+		moves = (moves_t *) &s2r[N_EPERM48];
+		self = (uint64_t *) &moves[N_EPERM48];
 
+		auto &magic = *(uint64_t *) &self[N_EPERM48];
+		if (magic != MAGIC) {
 			bool ok =
-				save(FNAME_S2R, s2r, N_EPERM48) &&
-				save(FNAME_MOVE, moves, N_EPERM48) &&
-				save(FNAME_SELF, self, N_EPERM48);
+				load(FNAME_S2R, s2r, N_EPERM48) &&
+				load(FNAME_MOVE, moves, N_EPERM48) &&
+				load(FNAME_SELF, self, N_EPERM48);
 			if (!ok) {
-				std::cerr << "error saving eperm48 tables\n";
+				std::cerr << "generating eperm48 tables\n";
+				generate();
+
+				bool ok =
+					save(FNAME_S2R, s2r, N_EPERM48) &&
+					save(FNAME_MOVE, moves, N_EPERM48) &&
+					save(FNAME_SELF, self, N_EPERM48);
+				if (!ok) {
+					std::cerr << "error saving eperm48 tables\n";
+				}
 			}
+
+			magic = MAGIC;
 		}
+
+		init_bucket();
 	});
 }
 
+void eperm48::free() {
+	alloc::shared_free(SHM_KEY);
+}
+
 eperm48::eperm48(cube c) : idx() {
-	eperm_t ep = c.getEdgePerm();
-	for (int s = 1; s < N_SYM48; s++) {
-		eperm_t ep_s = c.sym(s).getEdgePerm();
-		if (ep_s < ep) {
-			ep = ep_s;
-			idx = s;
+	auto [ key, s ] = ep_min(c.getEdgeVec());
+	idx = (coord_t(sym::inv(s)) << 24) | find(ep_rank(key));
+}
+
+void eperm48::init_bucket() {
+	if (!bucket) {
+		bucket = new coord_t[N_BUCKET + 1];
+	}
+
+	coord_t idx = 0;
+	for (size_t b = 0; b <= N_BUCKET; b++) {
+		while (idx < N_EPERM48 && (s2r[idx] >> BUCKET_SHIFT) < b) {
+			idx++;
 		}
+		bucket[b] = idx;
 	}
+}
 
-	auto it = std::lower_bound(s2r, s2r + N_EPERM48, ep);
-	idx = sym::inv(idx);
-	idx = (idx << 24) | std::distance(s2r, it);
+eperm48::coord_t eperm48::find(eperm_t ep) {
+	auto b = ep >> BUCKET_SHIFT;
+	auto first = s2r + bucket[b], last = s2r + bucket[b + 1];
+	return std::distance(s2r, std::lower_bound(first, last, ep));
 }
 
 void eperm48::generate() {
-	std::vector<coord_t> r2s(N_EPERM);
+	// One bit per raw permutation, set once it is known to be a
+	// non-representative image of a representative
+	constexpr size_t N_VISITED = (N_EPERM + 63) / 64;
+	auto visited = std::make_unique<std::atomic<uint64_t>[]>(N_VISITED);
 
 	std::barrier barrier(N_WORKERS);
-	std::vector<int> rep_base(N_WORKERS + 1);
+	std::vector<size_t> rep_base(N_WORKERS + 1);
 
 	parallel workers([&](size_t id) {
 		size_t block = N_EPERM / N_WORKERS;
 		size_t ep_start = id * block, ep_end = ep_start + block;
-		if (id == N_WORKERS) ep_end = N_EPERM;
+		if (id == N_WORKERS - 1) ep_end = N_EPERM;
 
 		std::vector<std::pair<eperm_t, uint64_t>> reps;
 
 		for (eperm_t ep = ep_start; ep < ep_end; ep++) {
-			cube c = cube{}.setEdgePerm(ep);
+			if ((visited[ep / 64].load(std::memory_order_relaxed) >> (ep % 64)) & 1) {
+				continue;
+			}
+
+			uint64_t keys[N_SYM48];
+			ep_keys(ep_unrank(ep), keys);
 
 			uint64_t self_sym = 0;
 			for (int s = 1; s < N_SYM48; s++) {
-				auto ep_s = c.sym(s).getEdgePerm();
-				if (ep_s == ep) {
+				if (keys[s] == keys[0]) {
 					self_sym |= 1LL << s;
-				} else if (ep_s < ep) {
+				} else if (keys[s] < keys[0]) {
 					self_sym = -1;
 					break;
 				}
 			}
-			if (self_sym != -1) {
-				reps.emplace_back(ep, self_sym);
+			if (self_sym == -1) {
+				continue;
+			}
+
+			reps.emplace_back(ep, self_sym);
+
+			uint64_t non_self = ((1LL << N_SYM48) - 2) ^ self_sym;
+			for (auto s : bits(non_self)) {
+				eperm_t ep_s = ep_rank(keys[s]);
+				visited[ep_s / 64].fetch_or(1LL << (ep_s % 64), std::memory_order_relaxed);
 			}
 		}
 
@@ -90,6 +230,10 @@ void eperm48::generate() {
 			for (int i = 1; i <= N_WORKERS; i++) {
 				rep_base[i] += rep_base[i - 1];
 			}
+			if (rep_base[N_WORKERS] != N_EPERM48) {
+				std::cerr << "eperm48: wrong number of representatives\n";
+				abort();
+			}
 		}
 
 		barrier.arrive_and_wait();
@@ -98,29 +242,27 @@ void eperm48::generate() {
 		for (auto [ ep, self_sym ] : reps) {
 			self[idx] = self_sym;
 			s2r[idx] = ep;
-			r2s[ep] = idx;
+			idx++;
+		}
 
-			cube c = cube{}.setEdgePerm(ep);
+		reps.clear();
+		reps.shrink_to_fit();
 
-			uint64_t non_self = ((1LL << N_SYM48) - 2) ^ self_sym;
-			for (auto s : bits(non_self)) {
-				r2s[c.sym(s).getEdgePerm()] = (coord_t(s) << 24) | idx;
-			}
+		barrier.arrive_and_wait();
 
-			idx++;
+		if (id == 0) {
+			init_bucket();
 		}
 
 		barrier.arrive_and_wait();
 
-		idx = rep_base[id];
-		for (auto [ ep, self_sym ] : reps) {
-			cube c = cube{}.setEdgePerm(ep);
+		for (idx = rep_base[id]; idx < rep_base[id + 1]; idx++) {
+			auto v = ep_unrank(s2r[idx]);
 
 			for (int m = 0; m < N_MOVES; m++) {
-				moves[idx][m] = r2s[c.move(m).getEdgePerm()];
+				auto [ key, s ] = ep_min(ep_move(v, m));
+				moves[idx][m] = (coord_t(sym::inv(s)) << 24) | find(ep_rank(key));
 			}
-
-			idx++;
 		}
 	});
 
@@ -8,18 +8,25 @@
 constexpr size_t N_EPERM48 = 9985968;
 
 class eperm48 {
+    public:
 	using coord_t = uint32_t;
 	using moves_t = coord_t[N_MOVES];
 
+    private:
 	coord_t idx;
 
 	eperm48(coord_t idx, coord_t sym) : idx(idx | (sym << 24)) {
 	}
 
 	static void generate();
+	static void init_bucket();
+
+	// index of a representative in s2r
+	static coord_t find(eperm_t ep);
 
     public:
 	static void init();
+	static void free();
 
 	eperm48(coord_t idx = 0) : idx(idx) { }
 	eperm48(cube c);
@@ -27,14 +34,19 @@ class eperm48 {
 	coord_t index() const { return idx & 0xffffff; }
 	coord_t sym() const { return idx >> 24; }
 
-	auto move_ex(int m) const {
+	// row must be the move table row for index()
+	auto move_ex(int m, const moves_t &row) const {
 		m = sym::movei(m, sym());
-		eperm48 ep = moves[index()][m];
+		eperm48 ep = row[m];
 		auto s = ep.sym();
 		ep = eperm48{ep.index(), sym::compose(s, sym())};
 		return std::tuple(ep, m, s);
 	}
 
+	auto move_ex(int m) const {
+		return move_ex(m, moves[index()]);
+	}
+
 	eperm48 move(int m) const {
 		return std::get<0>(move_ex(m));
 	}
@@ -48,6 +60,10 @@ class eperm48 {
 		return std::tuple(idx_m & 0xffffff, idx_m >> 24);
 	}
 
+	static const moves_t & move_row(size_t idx) {
+		return moves[idx];
+	}
+
 	static uint64_t selfsym(size_t idx) {
 		return self[idx];
 	}
@@ -57,9 +73,18 @@ class eperm48 {
 	inline static moves_t *moves = NULL;
 	inline static uint64_t *self = NULL;
 
+	// s2r positions bucketed by the high bits of the raw permutation,
+	// narrowing the search in find() to a couple of cache lines
+	static constexpr int BUCKET_SHIFT = 10;
+	static constexpr size_t N_BUCKET = N_EPERM >> BUCKET_SHIFT;
+	inline static coord_t *bucket = NULL;
+
 	static constexpr char FNAME_S2R[] = "eperm48S2R.dat";
 	static constexpr char FNAME_MOVE[] = "eperm48Move.dat";
 	static constexpr char FNAME_SELF[] = "eperm48SelfSym.dat";
+
+	static constexpr uint32_t SHM_KEY = 0x38347065;
+	static constexpr uint64_t MAGIC = 0x6c0f3e8b29d1a547;
 };
 
 #endif
@@ -119,18 +119,17 @@ class eprune_generator {
 
 void eprune::init() {
 	static std::once_flag flag;
-	constexpr size_t N_CACHE_LINE = N_EPERM48 * STRIPE;
 
 	std::call_once(flag, [&]() {
 		eperm48::init();
 		eorient::init();
 
-		index = alloc::shared<cache_line_t>(N_CACHE_LINE + 1, SHM_KEY);
+		index = alloc::shared<stripe_t>(N_EPERM48 + 1, SHM_KEY);
 		if (!index) {
 			std::cerr << "error getting shared memory for eprunei table\n";
 			abort();
 		}
-		auto &magic = *(uint64_t *) &index[N_CACHE_LINE];
+		auto &magic = *(uint64_t *) &index[N_EPERM48];
 		if (magic != MAGIC) {
 			std::cerr << "generating eprunei table\n";
 			generate();
@@ -151,17 +150,18 @@ void eprune::generate() {
 		size_t ep_start = block * id, ep_end = ep_start + block;
 		if (id == N_WORKERS - 1) ep_end = N_EPERM48;
 
-		// in case of partial failed load
-		std::fill(&index[ep_start * STRIPE], &index[ep_end * STRIPE], cache_line_t{});
-
 		for (auto ep = ep_start; ep < ep_end; ep++) {
-			auto cl_base = ep * STRIPE;
+			auto &stripe = index[ep];
+
+			// in case of partial failed load
+			std::fill(&stripe.cl[0], &stripe.cl[STRIPE], cache_line_t{});
+			std::copy(&eperm48::move_row(ep)[0], &eperm48::move_row(ep)[N_MOVES], &stripe.moves[0]);
 
 			for (int m = 0; m < N_MOVES; m++) {
 				auto [ ep_m, s_m ] = eperm48::raw_move(ep, m);
 
 				size_t sub = -1;
-				auto cl = &index[cl_base];
+				auto cl = &stripe.cl[0];
 
 				for (int eo = 0; eo < N_EORIENT; eo++) {
 					if (++sub == CL) {
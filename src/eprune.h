@@ -48,6 +48,14 @@ class eprune {
 		}
 	};
 
+	// Everything a search step needs for one eperm48 coordinate: its
+	// move table row followed by its eprune stripe, so both share a
+	// hugepage and the row is fetched alongside the prune data
+	struct alignas(64) stripe_t {
+		eperm48::moves_t moves;
+		alignas(64) cache_line_t cl[STRIPE];
+	};
+
     public:
 	static void init();
 	static void free();
@@ -58,7 +66,7 @@ class eprune {
 	};
 
 	static rec_t lookup(size_t ep, size_t eo) {
-		auto cl = &index[ep * STRIPE + eo / CL];
+		auto cl = &index[ep].cl[eo / CL];
 		auto sub = eo % CL;
 		return rec_t{cl->get_up(sub), cl->get_down(sub)};
 	}
@@ -68,13 +76,21 @@ class eprune {
 		return lookup(ep, eo);
 	}
 
+	// move using the co-located row, then look up the result
+	static std::pair<ecoord, rec_t> move(ecoord ec, int m) {
+		auto [ ep, eo ] = ec.coord();
+		auto ec_m = ec.move(m, index[ep].moves);
+		return std::make_pair(ec_m, lookup(ec_m));
+	}
+
 	static int probe(ecoord ec) {
 		int depth = 0;
+		auto r = lookup(ec);
 		while (!ec.is_solved()) {
 			depth++;
 			ec = ec.normalize();
-			int m = *bits(lookup(ec).down);
-			ec = ec.move(m);
+			int m = *bits(r.down);
+			std::tie(ec, r) = move(ec, m);
 		}
 		return depth;
 	}
@@ -82,9 +98,9 @@ class eprune {
     private:
 	static void generate();
 
-	inline static cache_line_t *index = NULL;
+	inline static stripe_t *index = NULL;
 	static constexpr uint32_t SHM_KEY = 0x6e727065;
-	static constexpr uint64_t MAGIC = 0x42d8375fde5b9c8b;
+	static constexpr uint64_t MAGIC = 0x9e21c4a07b3f5d16;
 };
 
 #endif
@@ -1,6 +1,7 @@
 #include <bitset>
 #include <map>
 #include "involution.h"
+#include "corner_hash.h"
 #include "bits.h"
 #include "thread.h"
 
@@ -100,6 +101,7 @@ void involution::init() {
 
 		edges_ = gen_edges();
 		corners_ = gen_corners();
+		corner_hash_init();
 
 		for (int parity = 0; parity < 2; parity++) {
 			for (cube c : corners_[parity]) {
@@ -1,13 +1,23 @@
 #include <iostream>
-#include <sstream>
 #include <format>
 #include <string>
 #include <vector>
-#include <map>
+#include <deque>
+#include <string_view>
+#include <memory>
+#include <cerrno>
+#include <unistd.h>
+#include <fcntl.h>
+#include <csignal>
+#include <sys/wait.h>
 #include "ecsolver.h"
 #include "neighborsolver.h"
 #include "involution.h"
 #include "tracker.h"
+#include "ecindex.h"
+#include "workunit.h"
+#include "solution_file.h"
+#include "archive.h"
 #include "interrupt.h"
 #include "thread.h"
 #include "status.h"
@@ -16,13 +26,36 @@ void cmd_help(const std::string &argv0);
 void cmd_count();
 void cmd_countall();
 void cmd_solutions();
+void cmd_export();
+void cmd_archive();
+void cmd_restore();
 void cmd_create();
 void cmd_ecoset(int depth);
 void cmd_neighbor();
 void cmd_unsolved();
 void cmd_ingest(bool optimal);
+void cmd_export_unit();
+void cmd_unit_solve();
+void cmd_merge();
+void cmd_pipeline();
 void cmd_free();
 
+// arguments after the command
+static std::vector<std::string> args;
+
+static bool has_option(const std::string &name) {
+	return std::find(args.begin(), args.end(), name) != args.end();
+}
+
+// the argument following an option, or def if it is not given
+static std::string option_value(const std::string &name, const std::string &def = "") {
+	auto it = std::find(args.begin(), args.end(), name);
+	if (it == args.end() || it + 1 == args.end()) {
+		return def;
+	}
+	return *(it + 1);
+}
+
 int main(int argc, char **argv) {
 	if (argc < 2) {
 		cmd_help(argv[0]);
@@ -30,6 +63,7 @@ int main(int argc, char **argv) {
 	}
 
 	std::string cmd = argv[1];
+	args.assign(argv + 2, argv + argc);
 
 	if (cmd == "count") {
 		cmd_count();
@@ -37,6 +71,12 @@ int main(int argc, char **argv) {
 		cmd_countall();
 	} else if (cmd == "solutions") {
 		cmd_solutions();
+	} else if (cmd == "export") {
+		cmd_export();
+	} else if (cmd == "archive") {
+		cmd_archive();
+	} else if (cmd == "restore") {
+		cmd_restore();
 	} else if (cmd == "create") {
 		cmd_create();
 	} else if (cmd == "ecoset15") {
@@ -51,6 +91,14 @@ int main(int argc, char **argv) {
 		cmd_ingest(false);
 	} else if (cmd == "optimal") {
 		cmd_ingest(true);
+	} else if (cmd == "export-unit") {
+		cmd_export_unit();
+	} else if (cmd == "unit-solve") {
+		cmd_unit_solve();
+	} else if (cmd == "merge") {
+		cmd_merge();
+	} else if (cmd == "pipeline") {
+		cmd_pipeline();
 	} else if (cmd == "free") {
 		cmd_free();
 	} else {
@@ -63,25 +111,47 @@ int main(int argc, char **argv) {
 
 void cmd_help(const std::string &argv0) {
 	std::cout <<
-		"usage: " << argv0 << " COMMAND\n"
+		"usage: " << argv0 << " COMMAND [OPTIONS]\n"
 		"\n"
 		"Commands:\n"
 		"    count      show solution count by depth\n"
 		"    countall   show solution count for all symmetries\n"
 		"    solutions  output symmetry representative solutions\n"
+		"    export FILE\n"
+		"               write all solutions to a binary file, by depth and coset\n"
+		"    archive FILE\n"
+		"               write a compressed copy of the database\n"
+		"    restore FILE\n"
+		"               add the solutions of an archive to the database\n"
 		"    create     make a new, empty involution database\n"
 		"    ecoset15   edge coset solver to depth 15 (for testing)\n"
 		"    ecoset18   edge coset solver to depth 18\n"
 		"    neighbor   find optimal neihghbors of known solutions\n"
 		"    unsolved   output unsolved cubes in singmaster notation\n"
+		"    unsolved --shards N --prefix P\n"
+		"               split unsolved cubes across files P.0 to P.N-1\n"
 		"    ingest     ingest solution move sequences\n"
 		"    optimal    ingest optimal solution move sequences\n"
+		"    export-unit START END FILE\n"
+		"               write cosets START to END - 1 as a work unit\n"
+		"    unit-solve DEPTH UNIT SHARD\n"
+		"               edge coset solver to DEPTH on a work unit\n"
+		"    merge SHARD...\n"
+		"               merge solved work units into the database\n"
+		"    pipeline --cmd COMMAND [--procs N] [--optimal]\n"
+		"               solve unsolved cubes with N solver processes, ingesting\n"
+		"               their solutions and solving neighbors as they arrive\n"
 		"    free       free shared memory\n"
+		"\n"
+		"Options:\n"
+		"    --hugepages  load invo.dat into 1 GB hugepages (ecoset, neighbor, ingest)\n"
+		"    --binary     read packed 11-byte solution records (ingest, optimal),\n"
+		"                 or write packed 20-byte cubes (unsolved)\n"
 		"\n";
 }
 
 void cmd_count() {
-	if (!tracker::open()) {
+	if (!tracker::open_readonly()) {
 		abort();
 	}
 	status::show_counts();
@@ -89,9 +159,10 @@ void cmd_count() {
 
 void cmd_countall() {
 	tracker::init();
-	if (!tracker::open()) {
+	if (!tracker::open_readonly()) {
 		abort();
 	}
+	tracker::open_counts();
 
 	size_t counts[MAX_DEPTH + 1] = {};
 
@@ -104,24 +175,12 @@ void cmd_countall() {
 			auto idx = ec_idx++;
 			lock.unlock();
 
-			tracker::handle handle(idx);
-			uint64_t edges_self = handle.self_sym;
-
-			size_t my_counts[MAX_DEPTH + 1] = {};
-			for (auto moves : tracker::get_solutions(idx)) {
-				cube c = cube::from_moveseq(moves);
-				uint64_t self = 1;
-				for (auto s : bits(edges_self)) {
-					if (c.symi(s) == c) {
-						self |= 1LL << s;
-					}
-				}
-				my_counts[moves.size()] += N_SYM48 / std::popcount(self);
-			}
+			// counted as the solutions were stored, or else from the solutions
+			auto &full = tracker::full_counts(idx);
 
 			lock.lock();
 			for (int i = 0; i <= MAX_DEPTH; i++) {
-				counts[i] += my_counts[i];
+				counts[i] += full[i];
 			}
 		}
 	});
@@ -134,15 +193,180 @@ void cmd_countall() {
 	}
 }
 
+// write all of buf to fd, false on error
+static bool write_buf(int fd, const std::vector<char> &buf) {
+	for (size_t n = 0; n < buf.size(); ) {
+		ssize_t r = write(fd, &buf[n], buf.size() - n);
+		if (r < 0 && errno != EINTR) {
+			perror("write");
+			return false;
+		}
+		n += std::max<ssize_t>(r, 0);
+	}
+	return true;
+}
+
+// write all of buf to fd, exits on error
+static void write_all(int fd, const std::vector<char> &buf) {
+	if (!write_buf(fd, buf)) {
+		exit(EXIT_FAILURE);
+	}
+}
+
 void cmd_solutions() {
-	if (!tracker::open()) {
+	if (!tracker::open_readonly()) {
 		abort();
 	}
-	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
-		for (auto moves : tracker::get_solutions(idx)) {
-			std::cout << moves.to_string() << '\n';
+
+	// chunks of cosets are formatted in parallel and written in order
+	// from a ring of buffers, one chunk per slot
+	constexpr size_t CHUNK_COSETS = 16;
+	constexpr size_t N_CHUNKS = (N_EDGE_INVO + CHUNK_COSETS - 1) / CHUNK_COSETS;
+	const size_t n_slots = 2 * N_WORKERS;
+
+	std::vector<std::vector<char>> slots(n_slots);
+	std::vector<uint8_t> ready(n_slots);
+
+	std::mutex mtx;
+	std::condition_variable free_cv;
+	size_t next_chunk = 0, output_chunk = 0;
+
+	static const char face[] = "URFDLB", power[] = "123";
+
+	parallel workers([&](size_t id) {
+		std::unique_lock lock(mtx);
+		while (next_chunk < N_CHUNKS) {
+			size_t chunk = next_chunk++;
+			auto &buf = slots[chunk % n_slots];
+			free_cv.wait(lock, [&] { return chunk < output_chunk + n_slots; });
+			lock.unlock();
+
+			size_t end = std::min<size_t>((chunk + 1) * CHUNK_COSETS, N_EDGE_INVO);
+
+			buf.clear();
+			for (size_t idx = chunk * CHUNK_COSETS; idx < end; idx++) {
+				for (auto &s : tracker::solutions(idx)) {
+					uint8_t moves[MAX_DEPTH];
+					int len = s.decode(moves);
+					size_t n = buf.size();
+					buf.resize(n + 2 * len + 1);
+					char *out = &buf[n];
+					for (int i = 0; i < len; i++) {
+						*out++ = face[moves[i] / 3];
+						*out++ = power[moves[i] % 3];
+					}
+					*out = '\n';
+				}
+			}
+
+			lock.lock();
+			ready[chunk % n_slots] = 1;
+
+			// whoever completes the next chunk in order writes out what is ready
+			if (chunk != output_chunk) {
+				continue;
+			}
+			while (output_chunk < N_CHUNKS && ready[output_chunk % n_slots]) {
+				auto &out = slots[output_chunk % n_slots];
+				lock.unlock();
+				write_all(STDOUT_FILENO, out);
+				lock.lock();
+				ready[output_chunk % n_slots] = 0;
+				output_chunk++;
+				free_cv.notify_all();
+			}
 		}
+	});
+
+	workers.join();
+}
+
+void cmd_export() {
+	if (args.size() != 1) {
+		std::cerr << "usage: export FILE\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (!tracker::open_readonly()) {
+		abort();
 	}
+	if (!solution_file::write(args[0])) {
+		std::cerr << "Error writing " << args[0] << "\n";
+		exit(EXIT_FAILURE);
+	}
+}
+
+void cmd_archive() {
+	if (args.size() != 1) {
+		std::cerr << "usage: archive FILE\n";
+		exit(EXIT_FAILURE);
+	}
+
+	if (!tracker::open_readonly()) {
+		abort();
+	}
+	if (!archive::write(args[0])) {
+		std::cerr << "Error writing " << args[0] << "\n";
+		exit(EXIT_FAILURE);
+	}
+}
+
+void cmd_restore() {
+	if (args.size() != 1) {
+		std::cerr << "usage: restore FILE\n";
+		exit(EXIT_FAILURE);
+	}
+
+	archive backup;
+	if (!backup.open(args[0])) {
+		exit(EXIT_FAILURE);
+	}
+
+	tracker::init();
+	if (!tracker::open()) {
+		abort();
+	}
+	tracker::lock();
+
+	std::mutex mtx;
+	size_t ec_idx = 0, n_restored = 0, n_skipped = 0;
+
+	status progress(N_EDGE_INVO);
+
+	parallel workers([&](size_t id) {
+		std::unique_lock lock(mtx);
+		while (ec_idx < N_EDGE_INVO) {
+			size_t idx = ec_idx++;
+			lock.unlock();
+
+			auto &bh = backup.headers()[idx];
+			auto h = tracker::get_header(idx);
+			bool ok = h.ep == bh.ep && h.eo == bh.eo && tracker::claim(idx);
+
+			size_t restored = 0;
+			if (ok) {
+				{
+					auto handle = tracker::handle(idx);
+					backup.for_each(idx, [&](const uint8_t *moves, int len) {
+						restored += handle.solution(moveseq(moves, moves + len));
+					});
+					handle.update_proven_min(bh.proven_min);
+				}
+				tracker::release(idx);
+			}
+
+			lock.lock();
+			n_restored += restored;
+			n_skipped += !ok;
+			progress.increment();
+		}
+	});
+
+	workers.join();
+	progress.stop();
+	tracker::close();
+
+	std::cout << std::format("{} solutions restored, {} cosets skipped\n", n_restored, n_skipped);
 }
 
 void cmd_create() {
@@ -154,7 +378,7 @@ void cmd_create() {
 
 void cmd_ecoset(int depth) {
 	tracker::init();
-	if (!tracker::open()) {
+	if (!tracker::open(has_option("--hugepages"))) {
 		abort();
 	}
 	tracker::lock();
@@ -172,10 +396,19 @@ void cmd_ecoset(int depth) {
 	parallel workers([&](size_t id) {
 		std::unique_lock lock(mtx);
 		while (true) {
+			// headers only move on, so a coset done as of opening is
+			// skipped unclaimed; others are checked again once claimed,
+			// and skipped if leased by another process
+			auto is_todo = [&](size_t idx) {
+				auto h = tracker::get_header(idx);
+				return h.proven_min <= depth && h.n_solved < h.n_cubes;
+			};
 			for (; ec_idx < N_EDGE_INVO; ec_idx++) {
-				auto h = tracker::get_header(ec_idx);
-				if (h.proven_min <= depth && h.n_solved < h.n_cubes) {
-					break;
+				if (is_todo(ec_idx) && tracker::claim(ec_idx)) {
+					if (is_todo(ec_idx)) {
+						break;
+					}
+					tracker::release(ec_idx);
 				}
 				progress.increment();
 			}
@@ -185,8 +418,11 @@ void cmd_ecoset(int depth) {
 			size_t idx = ec_idx++;
 
 			lock.unlock();
-			auto handle = tracker::handle(idx);
-			ecsolver{}.solve(handle, depth);
+			{
+				auto handle = tracker::handle(idx);
+				ecsolver{}.solve(handle, depth);
+			}
+			tracker::release(idx);
 			lock.lock();
 
 			progress.increment();
@@ -200,6 +436,7 @@ void cmd_ecoset(int depth) {
 
 	workers.join();
 	progress.stop();
+	tracker::close();
 
 	if (canceled) {
 		std::cout << "received terminate signal\n";
@@ -212,19 +449,11 @@ void cmd_neighbor() {
 	neighborsolver::init();
 
 	tracker::init();
-	if (!tracker::open()) {
+	if (!tracker::open(has_option("--hugepages"))) {
 		abort();
 	}
 	tracker::lock();
-
-	std::map<cube, std::pair<int, int>> ec_lookup;
-	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
-		auto h = tracker::get_header(idx);
-		cube edges = h.get_ec();
-		for (int s = 0; s < N_SYM48; s++) {
-			ec_lookup.emplace(edges.symi(s), std::make_pair(idx, s));
-		}
-	}
+	tracker::open_index();
 
 	interrupt::setup_signals();
 
@@ -240,34 +469,15 @@ void cmd_neighbor() {
 			size_t idx = ec_idx++;
 			lock.unlock();
 
-			cube edges = tracker::get_header(idx).get_ec();
-
-			std::map<size_t, std::vector<std::pair<int, int>>> neighbors;
-			for (int m = 0; m < N_MOVES; m++) {
-				cube edges_m = edges.premove(move::inv(m)).move(m).setCornerPerm(0);
-				auto [ ec_m, s ] = ec_lookup[edges_m];
-				if (idx <= ec_m) {
-					neighbors[ec_m].emplace_back(m, s);
-				}
+			// cosets leased by another process are left to it
+			if (!tracker::claim(idx)) {
+				lock.lock();
+				progress.increment();
+				continue;
 			}
 
-			auto handle = tracker::handle(idx);
-
-			for (auto [ idx_m, moves ] : neighbors) {
-				if (idx == idx_m) {
-					for (auto [ m, s ] : moves) {
-						neighborsolver(handle, handle).solve(m, s);
-					}
-				} else {
-					auto handle_m = tracker::handle(idx_m);
-					for (auto [ m, s ] : moves) {
-						int si = sym::inv(s);
-						int mi = move::inv(sym::movei(m, si));
-						neighborsolver(handle, handle_m).solve(m, s);
-						neighborsolver(handle_m, handle).solve(mi, si);
-					}
-				}
-			}
+			neighborsolver::solve(idx, false);
+			tracker::release(idx);
 
 			lock.lock();
 			progress.increment();
@@ -281,6 +491,7 @@ void cmd_neighbor() {
 
 	workers.join();
 	progress.stop();
+	tracker::close();
 
 	if (canceled) {
 		std::cout << "received terminate signal\n";
@@ -289,48 +500,151 @@ void cmd_neighbor() {
 	}
 }
 
-void cmd_unsolved() {
-	tracker::init();
-	if (!tracker::open()) {
-		abort();
+// writes buffers to a file descriptor from its own thread
+// - the fd is closed when finished, unless it is stdout
+// - after a failed write the fd is closed and later buffers are dropped
+class shard_writer {
+	static constexpr size_t MAX_QUEUE = 4;
+
+	int fd;
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::deque<std::vector<char>> queue;
+	bool done = false;
+	bool failed = false;
+	std::thread worker;
+
+    public:
+	shard_writer(int fd) : fd(fd) {
+		worker = std::thread([this]() { writer_thread(); });
 	}
-	tracker::lock();
 
-	auto corners = involution::corners();
+	~shard_writer() {
+		finish();
+	}
 
-	auto get_unsolved = [&](int idx) {
-		std::vector<cube> cubes;
+	void push(std::vector<char> &&buf) {
+		std::unique_lock lock(mtx);
+		cv.wait(lock, [&] { return queue.size() < MAX_QUEUE || failed; });
+		if (!failed) {
+			queue.push_back(std::move(buf));
+			cv.notify_all();
+		}
+	}
 
-		auto h = tracker::get_header(idx);
-		if (h.n_solved == h.n_cubes) {
-			return cubes;
+	// false if a write failed
+	bool finish() {
+		{
+			std::unique_lock lock(mtx);
+			done = true;
+			cv.notify_all();
+		}
+		if (worker.joinable()) {
+			worker.join();
+			close_fd();
 		}
+		return !failed;
+	}
 
-		cube edges = h.get_ec();
-		tracker::handle handle(idx);
+    private:
+	void writer_thread() {
+		std::unique_lock lock(mtx);
+		for (;;) {
+			cv.wait(lock, [&] { return !queue.empty() || done; });
+			if (queue.empty()) {
+				break;
+			}
+			auto buf = std::move(queue.front());
+			queue.pop_front();
+			cv.notify_all();
 
-		for (auto cc : corners[h.parity]) {
-			if (!handle.corner_set->test(corner_hash(cc))) {
-				continue;
+			lock.unlock();
+			bool ok = write_buf(fd, buf);
+			lock.lock();
+
+			if (!ok) {
+				std::cerr << std::format("dropping output to fd {}\n", fd);
+				close_fd();
+				failed = true;
+				queue.clear();
+				cv.notify_all();
+				break;
 			}
+		}
+	}
+
+	void close_fd() {
+		if (fd >= 0 && fd != STDOUT_FILENO) {
+			::close(fd);
+		}
+		fd = -1;
+	}
+};
 
-			cube c = edges * cube(cc);
+// the unsolved cubes of a coset, one per symmetry class
+static std::vector<cube> unsolved_cubes(int idx) {
+	std::vector<cube> cubes;
 
-			bool is_rep = true;
-			for (auto s : bits(handle.self_sym)) {
-				if (c.sym(s) < c) {
-					is_rep = false;
-					break;
-				}
+	auto h = tracker::get_header(idx);
+	if (h.n_solved == h.n_cubes) {
+		return cubes;
+	}
+
+	cube edges = h.get_ec();
+	tracker::handle handle(idx);
+
+	handle.for_each_unsolved([&](ccoord cc) {
+		cube c = edges * cube(cc);
+
+		bool is_rep = true;
+		for (auto s : bits(handle.self_sym)) {
+			if (c.sym(s) < c) {
+				is_rep = false;
+				break;
 			}
+		}
 
-			if (is_rep) {
-				cubes.push_back(c);
+		if (is_rep) {
+			cubes.push_back(c);
+		}
+	});
+
+	return cubes;
+}
+
+void cmd_unsolved() {
+	bool binary = has_option("--binary");
+	std::string prefix = option_value("--prefix");
+	int n_shards = std::stoi(option_value("--shards", "1"));
+	if (n_shards < 1 || (n_shards > 1 && prefix.empty())) {
+		std::cerr << "usage: unsolved [--shards N --prefix P] [--binary]\n";
+		exit(EXIT_FAILURE);
+	}
+
+	tracker::init();
+	if (!tracker::open_readonly()) {
+		abort();
+	}
+
+	std::vector<std::unique_ptr<shard_writer>> writers;
+	for (int i = 0; i < n_shards; i++) {
+		int fd = STDOUT_FILENO;
+		if (!prefix.empty()) {
+			std::string path = prefix + "." + std::to_string(i);
+			fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0) {
+				perror(path.c_str());
+				exit(EXIT_FAILURE);
 			}
 		}
+		writers.push_back(std::make_unique<shard_writer>(fd));
+	}
 
-		return cubes;
-	};
+	// cubes are dealt to the shards in turn, separately for each proven_min,
+	// so every shard gets an even share of the harder cosets
+	constexpr size_t FLUSH_BYTES = 1 << 20;
+	std::vector<std::vector<char>> pending(n_shards);
+	std::array<size_t, MAX_DEPTH + 2> next_shard = {};
 
 	std::mutex mtx;
 	std::vector<std::condition_variable> ec_cv(N_EDGE_INVO);
@@ -344,16 +658,47 @@ void cmd_unsolved() {
 
 			lock.unlock();
 
-			std::ostringstream buf;
-			auto cubes = get_unsolved(idx);
-			for (auto c : cubes) {
-				buf << c.to_sing() << '\n';
+			std::vector<char> buf;
+			std::vector<size_t> ends;
+			for (auto c : unsolved_cubes(idx)) {
+				if (binary) {
+					auto p = c.pack();
+					buf.insert(buf.end(), p.begin(), p.end());
+				} else {
+					auto s = c.to_sing();
+					buf.insert(buf.end(), s.begin(), s.end());
+					buf.push_back('\n');
+				}
+				ends.push_back(buf.size());
 			}
+			size_t &next = next_shard[std::min<int>(tracker::get_header(idx).proven_min, MAX_DEPTH + 1)];
 
 			lock.lock();
 			ec_cv[idx].wait(lock, [&] { return output_idx == idx; });
 
-			std::cout << buf.str();
+			size_t begin = 0;
+			for (auto end : ends) {
+				auto &out = pending[next++ % n_shards];
+				out.insert(out.end(), &buf[begin], &buf[end]);
+				begin = end;
+			}
+			std::vector<std::pair<int, std::vector<char>>> full;
+			for (int i = 0; i < n_shards; i++) {
+				if (pending[i].size() >= FLUSH_BYTES) {
+					full.emplace_back(i, std::move(pending[i]));
+					pending[i] = {};
+				}
+			}
+
+			// a full queue blocks here; other workers go on with their
+			// cosets, and the next one waits for its turn
+			if (!full.empty()) {
+				lock.unlock();
+				for (auto &[ i, out ] : full) {
+					writers[i]->push(std::move(out));
+				}
+				lock.lock();
+			}
 
 			output_idx++;
 			if (output_idx < N_EDGE_INVO) {
@@ -363,59 +708,589 @@ void cmd_unsolved() {
 	});
 
 	workers.join();
+	tracker::close();
+
+	bool ok = true;
+	for (int i = 0; i < n_shards; i++) {
+		if (!pending[i].empty()) {
+			writers[i]->push(std::move(pending[i]));
+		}
+		ok &= writers[i]->finish();
+	}
+	if (!ok) {
+		exit(EXIT_FAILURE);
+	}
+}
+
+// ingest input is read in large chunks of whole lines, or whole records
+// when binary
+static constexpr size_t CHUNK_BYTES = sizeof(tracker::solution) << 18;
+
+// reads the next chunk from fd, keeping a partial line or record in carry
+// for the next call; false after the last chunk
+static bool read_chunk(int fd, bool binary, std::vector<char> &carry, std::vector<char> &chunk) {
+	chunk = std::move(carry);
+	carry.clear();
+
+	size_t n = chunk.size();
+	chunk.resize(n + CHUNK_BYTES);
+	ssize_t r = read(fd, &chunk[n], CHUNK_BYTES);
+	if (r < 0) {
+		perror("read");
+		r = 0;
+	}
+	chunk.resize(n + r);
+	if (r == 0) {
+		return false;
+	}
+
+	size_t split = chunk.size();
+	if (binary) {
+		split -= split % sizeof(tracker::solution);
+	} else {
+		auto nl = std::find(chunk.rbegin(), chunk.rend(), '\n');
+		split = chunk.rend() - nl;
+	}
+	carry.assign(chunk.begin() + split, chunk.end());
+	chunk.resize(split);
+	return true;
+}
+
+// stores the solutions of a chunk, locking each coset once; cosets that
+// gained solutions are added to gained, if given
+static void ingest_chunk(std::string_view chunk, bool binary, bool optimal, std::vector<int> *gained = NULL) {
+	struct entry {
+		int idx;
+		moveseq moves;
+		cube c;
+	};
+	std::vector<entry> batch;
+
+	// solutions in any edge symmetry are moved into their coset's
+	auto add = [&](moveseq moves) {
+		if (moves.size() > MAX_DEPTH) {
+			std::cerr << "too long: " << moves.to_string() << "\n";
+			return;
+		}
+
+		cube c = cube::from_moveseq(moves);
+		if (c * c != cube{}) {
+			std::cerr << "not an involution: " << moves.to_string() << "\n";
+			return;
+		}
+
+		auto [ idx, s ] = ecindex::lookup(c);
+		if (idx < 0) {
+			std::cerr << "not in any edge coset: " << moves.to_string() << "\n";
+			return;
+		}
+		if (s != 0) {
+			for (auto &m : moves) {
+				m = sym::move(m, s);
+			}
+			c = c.sym(s);
+		}
+
+		batch.push_back({ idx, moves, c });
+	};
+
+	if (binary) {
+		auto records = (const tracker::solution *) chunk.data();
+		size_t n = chunk.size() / sizeof(tracker::solution);
+		for (size_t i = 0; i < n; i++) {
+			if (!records[i].valid() || records[i].length() > MAX_DEPTH) {
+				std::cerr << "invalid record\n";
+				continue;
+			}
+			add(records[i]);
+		}
+	} else {
+		while (!chunk.empty()) {
+			size_t nl = std::min(chunk.find('\n'), chunk.size());
+			auto line = chunk.substr(0, nl);
+			chunk.remove_prefix(std::min(nl + 1, chunk.size()));
+			if (line.empty()) {
+				continue;
+			}
+			moveseq moves;
+			if (!moveseq::parse(line, moves)) {
+				std::cerr << "too long: " << line << "\n";
+				continue;
+			}
+			add(moves);
+		}
+	}
+
+	std::stable_sort(batch.begin(), batch.end(),
+		[](const entry &a, const entry &b) { return a.idx < b.idx; });
+
+	for (auto first = batch.begin(); first != batch.end(); ) {
+		int idx = first->idx;
+		auto last = std::find_if(first, batch.end(),
+			[&](const entry &e) { return e.idx != idx; });
+
+		if (!tracker::claim(idx)) {
+			for (; first != last; ++first) {
+				std::cerr << "coset leased by another process: " << first->moves.to_string() << "\n";
+			}
+			continue;
+		}
+
+		{
+			auto handle = tracker::handle(idx);
+			int n_solved = handle.n_solved();
+			for (; first != last; ++first) {
+				bool proven = optimal || (first->moves.size() == handle.proven_min());
+				if (proven && handle.is_unsolved(first->c)) {
+					handle.solution(first->moves.canonical());
+				}
+			}
+			if (gained && handle.n_solved() != n_solved) {
+				gained->push_back(idx);
+			}
+		}
+		tracker::release(idx);
+	}
 }
 
 void cmd_ingest(bool optimal) {
+	bool binary = has_option("--binary");
+
 	tracker::init();
-	if (!tracker::open()) {
+	if (!tracker::open(has_option("--hugepages"))) {
 		abort();
 	}
 	tracker::lock();
+	tracker::open_index();
+
+	interrupt::setup_signals();
+
+	// a reader thread splits stdin into chunks for the workers
+	const size_t max_chunks = 2 * N_WORKERS;
+
+	std::mutex mtx;
+	std::condition_variable chunk_cv, space_cv;
+	std::deque<std::vector<char>> chunks;
+	bool input_done = false, workers_done = false;
+
+	std::thread reader([&]() {
+		std::vector<char> carry;
+		bool more = true;
+		while (more && !interrupt::terminated()) {
+			std::vector<char> chunk;
+			more = read_chunk(STDIN_FILENO, binary, carry, chunk);
+
+			std::unique_lock lock(mtx);
+			space_cv.wait(lock, [&] { return chunks.size() < max_chunks || workers_done; });
+			if (workers_done) {
+				break;
+			}
+			chunks.push_back(std::move(chunk));
+			chunk_cv.notify_one();
+		}
+
+		std::unique_lock lock(mtx);
+		input_done = true;
+		chunk_cv.notify_all();
+	});
+
+	parallel workers([&](size_t id) {
+		while (!interrupt::terminated()) {
+			std::vector<char> chunk;
+			{
+				std::unique_lock lock(mtx);
+				chunk_cv.wait(lock, [&] { return !chunks.empty() || input_done; });
+				if (chunks.empty()) {
+					break;
+				}
+				chunk = std::move(chunks.front());
+				chunks.pop_front();
+				space_cv.notify_one();
+			}
+
+			ingest_chunk({ chunk.data(), chunk.size() }, binary, optimal);
+		}
+	});
 
-	std::map<cube, int> ec_lookup;
-	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
-		cube edges = tracker::get_header(idx).get_ec();
-		ec_lookup.emplace(edges, idx);
+	workers.join();
+	{
+		// stopped early, the reader may be waiting for space
+		std::unique_lock lock(mtx);
+		workers_done = true;
+		space_cv.notify_all();
+	}
+	reader.join();
+	tracker::close();
+
+	if (interrupt::terminated()) {
+		std::cout << "received terminate signal\n";
+	} else {
+		std::cout << "done\n";
+	}
+}
+
+void cmd_export_unit() {
+	if (args.size() != 3) {
+		std::cerr << "usage: export-unit START END FILE\n";
+		exit(EXIT_FAILURE);
+	}
+
+	size_t start = std::stoul(args[0]);
+	size_t end = std::min<size_t>(std::stoul(args[1]), N_EDGE_INVO);
+
+	tracker::init();
+	if (!tracker::open_readonly()) {
+		abort();
+	}
+
+	auto unit = workunit::from_tracker(start, std::max(start, end));
+	if (!unit.save(args[2])) {
+		perror(args[2].c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	std::cout << std::format("exported cosets {} to {}, {} solutions\n",
+		unit.start, unit.end, unit.solutions.size());
+}
+
+void cmd_unit_solve() {
+	if (args.size() != 3) {
+		std::cerr << "usage: unit-solve DEPTH UNIT SHARD\n";
+		exit(EXIT_FAILURE);
 	}
 
+	int depth = std::stoi(args[0]);
+
+	ecsolver::init();
+
+	workunit unit;
+	if (!unit.load(args[1])) {
+		exit(EXIT_FAILURE);
+	}
+	tracker::open_memory(unit.start, unit.headers, unit.solutions, std::move(unit.unsolved));
+
 	interrupt::setup_signals();
 
 	std::mutex mtx;
+	size_t ec_idx = unit.start;
+
+	status progress(unit.end - unit.start);
 
 	parallel workers([&](size_t id) {
-		std::string line;
+		std::unique_lock lock(mtx);
 		while (!interrupt::terminated()) {
-			mtx.lock();
-			bool ok = bool(getline(std::cin, line));
-			mtx.unlock();
-			if (!ok) {
+			for (; ec_idx < unit.end; ec_idx++) {
+				auto h = tracker::get_header(ec_idx);
+				if (h.proven_min <= depth && h.n_solved < h.n_cubes) {
+					break;
+				}
+				progress.increment();
+			}
+			if (ec_idx == unit.end) {
 				break;
 			}
+			size_t idx = ec_idx++;
 
-			moveseq moves = moveseq::parse(line);
-			cube c = cube::from_moveseq(moves);
-			if (c * c != cube{}) {
-				std::cerr << "not an involution: " << line << "\n";
-				continue;
+			lock.unlock();
+			auto handle = tracker::handle(idx);
+			ecsolver{}.solve(handle, depth);
+			lock.lock();
+
+			progress.increment();
+		}
+	});
+
+	workers.join();
+	progress.stop();
+
+	// an interrupted shard is still valid, proven_min only advances
+	// once a depth is searched completely
+	auto shard = workunit::from_tracker(unit.start, unit.end);
+	for (size_t i = 0; i < shard.headers.size(); i++) {
+		shard.headers[i].offset = unit.headers[i].offset;
+	}
+	if (!shard.save(args[2])) {
+		perror(args[2].c_str());
+		exit(EXIT_FAILURE);
+	}
+
+	if (interrupt::terminated()) {
+		std::cout << "received terminate signal\n";
+	} else {
+		std::cout << "done\n";
+	}
+}
+
+void cmd_merge() {
+	tracker::init();
+	if (!tracker::open()) {
+		abort();
+	}
+	tracker::lock();
+
+	for (auto &path : args) {
+		workunit shard;
+		if (!shard.load(path)) {
+			continue;
+		}
+
+		// solutions of each coset start after those of the cosets before it
+		std::vector<size_t> first(shard.headers.size() + 1);
+		for (size_t i = 0; i < shard.headers.size(); i++) {
+			first[i + 1] = first[i] + shard.headers[i].n_solved;
+		}
+
+		std::mutex mtx;
+		size_t ec_idx = shard.start;
+		size_t n_merged = 0, n_skipped = 0;
+
+		parallel workers([&](size_t id) {
+			std::unique_lock lock(mtx);
+			while (ec_idx < shard.end) {
+				size_t idx = ec_idx++;
+				lock.unlock();
+
+				auto &sh = shard.headers[idx - shard.start];
+				auto solutions = shard.solutions.data() + first[idx - shard.start];
+
+				// solutions must be involutions of this coset no longer
+				// than the depth the shard proved, or the coset is skipped
+				auto h = tracker::get_header(idx);
+				cube edges = h.get_ec();
+				auto is_valid = [&](const tracker::solution &s) {
+					cube c = s.to_cube();
+					return s.length() <= sh.proven_min && c * c == cube{} &&
+						c.setCornerPerm(0) == edges;
+				};
+				bool match = h.ep == sh.ep && h.eo == sh.eo;
+				if (match && !std::all_of(solutions, solutions + sh.n_solved, is_valid)) {
+					std::cerr << std::format("{}: invalid solutions for coset {}\n", path, idx);
+					match = false;
+				}
+				bool ok = match && tracker::claim(idx);
+
+				size_t merged = 0;
+				if (ok) {
+					{
+						auto handle = tracker::handle(idx);
+						for (size_t i = 0; i < sh.n_solved; i++) {
+							merged += handle.solution(solutions[i]);
+						}
+						handle.update_proven_min(sh.proven_min);
+					}
+					tracker::release(idx);
+				}
+
+				lock.lock();
+				n_merged += merged;
+				n_skipped += !ok;
 			}
+		});
 
-			auto it = ec_lookup.find(c.setCornerPerm(0));
-			if (it == ec_lookup.end()) {
-				std::cerr << "edge symmetry not canonical: " << line << "\n";
-				continue;
+		workers.join();
+
+		std::cout << std::format("{}: {} new solutions, {} cosets skipped\n",
+			path, n_merged, n_skipped);
+	}
+
+	tracker::close();
+}
+
+void cmd_pipeline() {
+	std::string command = option_value("--cmd");
+	int n_procs = std::stoi(option_value("--procs", "1"));
+	bool optimal = has_option("--optimal");
+	if (command.empty() || n_procs < 1) {
+		std::cerr << "usage: pipeline --cmd COMMAND [--procs N] [--optimal]\n";
+		exit(EXIT_FAILURE);
+	}
+
+	// solvers read cubes on stdin and write solutions on stdout; they are
+	// started first so they inherit nothing of the database
+	struct solver {
+		pid_t pid;
+		int in, out;
+	};
+	std::vector<solver> solvers;
+	for (int i = 0; i < n_procs; i++) {
+		int in[2], out[2];
+		if (pipe2(in, O_CLOEXEC) != 0 || pipe2(out, O_CLOEXEC) != 0) {
+			perror("pipe");
+			exit(EXIT_FAILURE);
+		}
+
+		pid_t pid = fork();
+		if (pid < 0) {
+			perror("fork");
+			exit(EXIT_FAILURE);
+		}
+		if (pid == 0) {
+			dup2(in[0], STDIN_FILENO);
+			dup2(out[1], STDOUT_FILENO);
+			execl("/bin/sh", "sh", "-c", command.c_str(), (char *) NULL);
+			perror("/bin/sh");
+			_exit(127);
+		}
+
+		::close(in[0]);
+		::close(out[1]);
+		solvers.push_back({ pid, in[1], out[0] });
+	}
+
+	// a solver that exits early fails our writes to it, and its writer
+	// drops the rest of its cubes, instead of SIGPIPE killing us
+	signal(SIGPIPE, SIG_IGN);
+
+	neighborsolver::init();
+
+	tracker::init();
+	if (!tracker::open(has_option("--hugepages"))) {
+		abort();
+	}
+	tracker::lock();
+	tracker::open_index();
+
+	interrupt::setup_signals();
+
+	std::mutex mtx;
+	std::condition_variable queue_cv;
+	std::deque<int> queue;
+	std::vector<uint8_t> queued(N_EDGE_INVO);
+	int n_reading = n_procs;
+	size_t n_cubes = 0, n_gained = 0;
+
+	// solutions are ingested as they arrive, one reader per solver, and
+	// cosets that gained solutions are queued for the neighbor solver
+	std::vector<std::thread> readers;
+	for (auto &p : solvers) {
+		readers.emplace_back([&, fd = p.out]() {
+			std::vector<char> carry, chunk;
+			std::vector<int> gained;
+			bool more = true;
+			while (more) {
+				more = read_chunk(fd, false, carry, chunk);
+				gained.clear();
+				ingest_chunk({ chunk.data(), chunk.size() }, false, optimal, &gained);
+
+				std::unique_lock lock(mtx);
+				for (auto idx : gained) {
+					n_gained++;
+					if (!queued[idx]) {
+						queued[idx] = 1;
+						queue.push_back(idx);
+					}
+				}
+				queue_cv.notify_all();
 			}
-			auto idx = it->second;
+			::close(fd);
 
-			auto handle = tracker::handle(idx);
-			bool proven = optimal || (moves.size() == handle.proven_min());
-			if (proven && handle.is_unsolved(c)) {
-				handle.solution(moves.canonical());
+			std::unique_lock lock(mtx);
+			n_reading--;
+			queue_cv.notify_all();
+		});
+	}
+
+	parallel neighbors([&](size_t id) {
+		std::unique_lock lock(mtx);
+		for (;;) {
+			queue_cv.wait(lock, [&] { return !queue.empty() || n_reading == 0; });
+			if (queue.empty()) {
+				break;
+			}
+			int idx = queue.front();
+			queue.pop_front();
+			queued[idx] = 0;
+			lock.unlock();
+
+			if (!interrupt::terminated() && tracker::claim(idx)) {
+				neighborsolver::solve(idx, true);
+				tracker::release(idx);
 			}
+			lock.lock();
 		}
 	});
 
-	workers.join();
+	// cubes are dealt to the solvers as in unsolved --shards; a full
+	// queue holds back the generator until its solver catches up
+	constexpr size_t FLUSH_BYTES = 1 << 16;
+	std::vector<std::unique_ptr<shard_writer>> writers;
+	for (auto &p : solvers) {
+		writers.push_back(std::make_unique<shard_writer>(p.in));
+	}
+	std::vector<std::vector<char>> pending(n_procs);
+	std::array<size_t, MAX_DEPTH + 2> next_proc = {};
+
+	std::mutex gen_mtx;
+	size_t ec_idx = 0;
+
+	parallel generators([&](size_t id) {
+		std::unique_lock lock(gen_mtx);
+		while (ec_idx < N_EDGE_INVO && !interrupt::terminated()) {
+			size_t idx = ec_idx++;
+			lock.unlock();
+
+			std::vector<std::string> lines;
+			if (tracker::claim(idx)) {
+				for (auto c : unsolved_cubes(idx)) {
+					lines.push_back(c.to_sing() + '\n');
+				}
+				tracker::release(idx);
+			}
+			size_t &next = next_proc[std::min<int>(tracker::get_header(idx).proven_min, MAX_DEPTH + 1)];
+
+			lock.lock();
+			for (auto &line : lines) {
+				auto &out = pending[next++ % n_procs];
+				out.insert(out.end(), line.begin(), line.end());
+			}
+			n_cubes += lines.size();
+			std::vector<std::pair<int, std::vector<char>>> full;
+			for (int i = 0; i < n_procs; i++) {
+				if (pending[i].size() >= FLUSH_BYTES) {
+					full.emplace_back(i, std::move(pending[i]));
+					pending[i] = {};
+				}
+			}
+
+			// a full queue blocks here, not the other generators
+			if (!full.empty()) {
+				lock.unlock();
+				for (auto &[ i, out ] : full) {
+					writers[i]->push(std::move(out));
+				}
+				lock.lock();
+			}
+		}
+	});
+
+	generators.join();
+
+	// end of input lets the solvers finish
+	for (int i = 0; i < n_procs; i++) {
+		if (!pending[i].empty() && !interrupt::terminated()) {
+			writers[i]->push(std::move(pending[i]));
+		}
+		writers[i]->finish();
+		if (interrupt::terminated()) {
+			kill(solvers[i].pid, SIGTERM);
+		}
+	}
+
+	for (auto &r : readers) {
+		r.join();
+	}
+	neighbors.join();
+
+	for (auto &p : solvers) {
+		int status;
+		if (waitpid(p.pid, &status, 0) == p.pid && status != 0) {
+			std::cerr << std::format("solver {} exited with status {}\n", p.pid, status);
+		}
+	}
+
+	tracker::close();
 
+	std::cout << std::format("{} cubes sent, {} coset updates\n", n_cubes, n_gained);
 	if (interrupt::terminated()) {
 		std::cout << "received terminate signal\n";
 	} else {
@@ -425,4 +1300,5 @@ void cmd_ingest(bool optimal) {
 
 void cmd_free() {
 	eprune::free();
+	eperm48::free();
 }
@@ -1,7 +1,17 @@
 #include "moveseq.h"
 
-moveseq moveseq::parse(const std::string &s) {
-	moveseq moves;
+bool moveseq::parse(std::string_view s, moveseq &moves) {
+	moves.clear();
+
+	// leaves room for canonical()
+	bool ok = true;
+	auto push_back = [&](uint8_t m) {
+		if (moves.size() < CAPACITY - 1) {
+			moves.push_back(m);
+		} else {
+			ok = false;
+		}
+	};
 
 	int face = -1;
 	for (auto ch : s) {
@@ -21,20 +31,20 @@ moveseq moveseq::parse(const std::string &s) {
 
 		if (f != -1) {
 			if (face != -1) {
-				moves.push_back(face);
+				push_back(face);
 			}
 			face = f;
 		} else if (power != -1 && face != -1) {
-			moves.push_back(face + power);
+			push_back(face + power);
 			face = -1;
 		}
 	}
 
 	if (face != -1) {
-		moves.push_back(face);
+		push_back(face);
 	}
 
-	return moves;
+	return ok;
 }
 
 moveseq moveseq::canonical() const {
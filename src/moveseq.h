@@ -2,15 +2,84 @@
 #define INVL_MOVESEQ_H
 
 #include <cstdint>
-#include <vector>
+#include <cstdlib>
+#include <array>
+#include <algorithm>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 
-struct moveseq : public std::vector<uint8_t> {
-	using std::vector<uint8_t>::vector;
+// sequence of at most CAPACITY moves, stored inline so copies and
+// push_back never allocate; going past CAPACITY aborts
+// - canonical() needs room for one more move than it is given
+// - parse() fails on more than CAPACITY - 1 moves
 
-	static moveseq parse(const std::string &);
+struct moveseq {
+	static constexpr size_t CAPACITY = 24;
+
+	using value_type = uint8_t;
+	using iterator = uint8_t *;
+	using const_iterator = const uint8_t *;
+
+	moveseq() = default;
+
+	moveseq(std::initializer_list<uint8_t> moves) : moveseq(moves.begin(), moves.end()) {
+	}
+
+	template<typename It>
+	moveseq(It first, It last) {
+		for (; first != last; ++first) {
+			push_back(*first);
+		}
+	}
+
+	// false if s has more moves than canonical() has room for
+	static bool parse(std::string_view s, moveseq &moves);
 	moveseq canonical() const;
 	std::string to_string() const;
+
+	size_t size() const { return n; }
+	bool empty() const { return n == 0; }
+
+	uint8_t * data() { return &moves[0]; }
+	const uint8_t * data() const { return &moves[0]; }
+
+	iterator begin() { return &moves[0]; }
+	iterator end() { return &moves[n]; }
+	const_iterator begin() const { return &moves[0]; }
+	const_iterator end() const { return &moves[n]; }
+
+	uint8_t & operator [] (size_t i) { return moves[i]; }
+	uint8_t operator [] (size_t i) const { return moves[i]; }
+
+	uint8_t & back() { return moves[n - 1]; }
+	uint8_t back() const { return moves[n - 1]; }
+
+	void push_back(uint8_t m) {
+		if (n == CAPACITY) abort();
+		moves[n++] = m;
+	}
+
+	void pop_back() { n--; }
+
+	void resize(size_t size) {
+		if (size > CAPACITY) abort();
+		n = size;
+	}
+
+	void clear() { n = 0; }
+
+	bool operator == (const moveseq &o) const {
+		return std::equal(begin(), end(), o.begin(), o.end());
+	}
+
+	bool operator < (const moveseq &o) const {
+		return std::lexicographical_compare(begin(), end(), o.begin(), o.end());
+	}
+
+    private:
+	uint8_t n = 0;
+	std::array<uint8_t, CAPACITY> moves = {};
 };
 
 #endif
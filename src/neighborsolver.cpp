@@ -1,6 +1,8 @@
+#include <map>
 #include "neighborsolver.h"
 #include "thread.h"
 #include "tracker.h"
+#include "ecindex.h"
 #include "involution.h"
 
 void neighborsolver::init() {
@@ -11,23 +13,112 @@ void neighborsolver::init() {
 	});
 }
 
-void neighborsolver::solve(int m, int s) {
-	sanity_check_move_and_symmetry(m, s);
+void neighborsolver::solve(int idx, bool all) {
+	cube edges = tracker::get_header(idx).get_ec();
 
-	int mi = move::inv(m);
+	std::map<int, std::vector<std::pair<int, int>>> neighbors;
+	for (int m = 0; m < N_MOVES; m++) {
+		cube edges_m = edges.premove(move::inv(m)).move(m).setCornerPerm(0);
+		auto [ ec_m, s ] = ecindex::lookup(edges_m);
+		if (all || idx <= ec_m) {
+			neighbors[ec_m].emplace_back(m, s);
+		}
+	}
+
+	// neighbors leased by another process are left out
+	std::erase_if(neighbors, [](auto &n) { return !tracker::claim(n.first); });
+
+	// moves are taken one at a time, each reading its sources after the
+	// moves before it stored into them, so solutions found through one
+	// move are wrapped by the next
+	source src;
+	for (auto &[ idx_m, moves ] : neighbors) {
+		source other;
+		for (auto [ m, s ] : moves) {
+			read(idx, src);
+			store(idx_m, src, { { m, s } });
+			if (idx_m == idx) {
+				continue;
+			}
+
+			int si = sym::inv(s);
+			read(idx_m, other);
+			store(idx, other, { { move::inv(sym::movei(m, si)), si } });
+		}
+	}
+
+	for (auto &[ idx_m, moves ] : neighbors) {
+		tracker::release(idx_m);
+	}
+}
+
+// brings src up to date with coset idx; solutions of a claimed coset are
+// only added, so only those added since the last read are decoded
+void neighborsolver::read(int idx, source &src) {
+	src.idx = idx;
+	size_t n = src.solutions.size();
+
+	tracker::lock(idx);
+	auto solutions = tracker::solutions(idx);
+	src.solutions.insert(src.solutions.end(), solutions.begin() + n, solutions.end());
+	tracker::unlock(idx);
+
+	src.cubes.resize(src.solutions.size());
+	for (size_t i = n; i < src.solutions.size(); i++) {
+		src.cubes[i] = src.solutions[i].to_cube();
+	}
+}
+
+void neighborsolver::store(int target, const source &src, const std::vector<std::pair<int, int>> &moves) {
+	// n_solved only grows, so a solved coset stays solved
+	tracker::lock(target);
+	auto h = tracker::get_header(target);
+	tracker::unlock(target);
+	if (h.n_solved == h.n_cubes || src.cubes.empty()) {
+		return;
+	}
+
+	// corner hashes of every wrapped solution, computed without the lock
+	struct candidate {
+		uint32_t sol;
+		uint16_t hash;
+		uint8_t move;
+	};
+	std::vector<candidate> candidates;
+	std::vector<cube> wrapped(src.cubes.size());
+	std::vector<uint16_t> hashes(src.cubes.size());
+
+	for (size_t j = 0; j < moves.size(); j++) {
+		auto [ m, s ] = moves[j];
+		sanity_check_move_and_symmetry(src.idx, target, m, s);
+
+		for (size_t k = 0; k < src.cubes.size(); k++) {
+			wrapped[k] = wrap(src.cubes[k], m, s);
+		}
+		corner_hash(wrapped.data(), wrapped.size(), hashes.data());
+
+		for (size_t k = 0; k < hashes.size(); k++) {
+			candidates.push_back({ uint32_t(k), hashes[k], uint8_t(j) });
+		}
+	}
+
+	auto h1 = tracker::handle(target);
 	int goal = h1.proven_min();
 
-	for (moveseq sol : tracker::get_solutions(h0.idx)) {
-		cube c = wrap(cube::from_moveseq(sol), m, s);
-		ccoord cc = c;
-		if (!h1.is_unsolved(cc)) {
+	for (auto &c : candidates) {
+		if (!h1.corner_set->test(c.hash)) {
 			continue;
 		}
 
+		auto [ m, s ] = moves[c.move];
+
+		uint8_t seq[MAX_DEPTH];
+		int len = src.solutions[c.sol].decode(seq);
+
 		moveseq sol_m;
-		sol_m.push_back(sym::move(mi, s));
-		for (auto m : sol) {
-			sol_m.push_back(sym::move(m, s));
+		sol_m.push_back(sym::move(move::inv(m), s));
+		for (int i = 0; i < len; i++) {
+			sol_m.push_back(sym::move(seq[i], s));
 		}
 		sol_m.push_back(sym::move(m, s));
 		sol_m = sol_m.canonical();
@@ -1,29 +1,44 @@
 #ifndef INVL_NEIGHBORSOLVER_H
 #define INVL_NEIGHBORSOLVER_H
 
+#include <vector>
 #include "tracker.h"
 
-class neighborsolver {
-	tracker::handle &h0, &h1;
+// finds solutions m' s m of the neighbors of known solutions s
+// - each coset's solutions are decoded once, then wrapped by every move
+//   and symmetry leading to a neighbor without holding a lock
+// - a target coset is locked once per move to store its hits
 
-	cube wrap(cube c, int m, int s) {
+class neighborsolver {
+	// the solutions of a coset as they were when last read
+	struct source {
+		int idx = -1;
+		std::vector<tracker::solution> solutions;
+		std::vector<cube> cubes;
+	};
+
+	static cube wrap(cube c, int m, int s) {
 		return c.premove(move::inv(m)).move(m).sym(s);
 	}
 
-	void sanity_check_move_and_symmetry(int m, int s) {
-		cube c0 = h0.ec(), c1 = h1.ec();
+	static void sanity_check_move_and_symmetry(int idx0, int idx1, int m, int s) {
+		cube c0 = tracker::get_header(idx0).get_ec();
+		cube c1 = tracker::get_header(idx1).get_ec();
 		if (wrap(c0, m, s).setCornerPerm(0) != c1) {
 			abort();
 		}
 	}
 
+	static void read(int idx, source &src);
+	static void store(int target, const source &src, const std::vector<std::pair<int, int>> &moves);
+
     public:
 	static void init();
 
-	neighborsolver(tracker::handle &h0, tracker::handle &h1) : h0(h0), h1(h1) {
-	}
-
-	void solve(int m, int s);
+	// solves the neighbors of coset idx, which must be claimed, from its
+	// solutions and theirs; unless all, only neighbors at idx or above,
+	// as when every coset is visited in turn
+	static void solve(int idx, bool all);
 };
 
 #endif
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <filesystem>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "solution_file.h"
+#include "thread.h"
+#include "alloc.h"
+
+bool solution_file::write(const std::string &path) {
+	// record positions follow from the per-depth counts in the headers
+	std::vector<tracker::header> head(N_EDGE_INVO);
+	auto index = std::make_unique<index_t[]>(MAX_DEPTH + 1);
+	file_header fh = { MAGIC, N_EDGE_INVO, 0, {} };
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		head[idx] = tracker::get_header(idx);
+	}
+	for (int d = 0; d <= MAX_DEPTH; d++) {
+		auto &ix = index[d];
+		for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+			ix[idx + 1] = ix[idx] + head[idx].n_length[d];
+		}
+		fh.depth_start[d + 1] = fh.depth_start[d] + ix[N_EDGE_INVO];
+	}
+	fh.n_solutions = fh.depth_start[MAX_DEPTH + 1];
+
+	auto tmp = path + ".tmp";
+	int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd == -1 || ftruncate(fd, file_size(fh.n_solutions)) != 0) {
+		perror(tmp.c_str());
+		return false;
+	}
+
+	auto pwrite_all = [&](const void *buf, size_t n, size_t offset) {
+		return pwrite(fd, buf, n, offset) == n;
+	};
+
+	size_t head_offset = sizeof(fh);
+	size_t index_offset = head_offset + N_EDGE_INVO * sizeof(tracker::header);
+	size_t records_offset = index_offset + (MAX_DEPTH + 1) * sizeof(index_t);
+
+	bool ok = pwrite_all(&fh, sizeof(fh), 0) &&
+		pwrite_all(&head[0], N_EDGE_INVO * sizeof(tracker::header), head_offset) &&
+		pwrite_all(&index[0], (MAX_DEPTH + 1) * sizeof(index_t), index_offset);
+
+	// records of a depth in consecutive cosets are consecutive, so each
+	// chunk of cosets is one write per depth
+	constexpr size_t CHUNK_COSETS = 64;
+	std::atomic<size_t> next = 0;
+	std::atomic<bool> failed = !ok;
+
+	parallel workers([&](size_t id) {
+		std::array<std::vector<tracker::solution>, MAX_DEPTH + 1> by_depth;
+		size_t start;
+		while ((start = next.fetch_add(CHUNK_COSETS)) < N_EDGE_INVO && !failed) {
+			size_t end = std::min<size_t>(start + CHUNK_COSETS, N_EDGE_INVO);
+			for (size_t idx = start; idx < end; idx++) {
+				for (auto &s : tracker::solutions(idx)) {
+					by_depth[s.length()].push_back(s);
+				}
+			}
+
+			for (int d = 0; d <= MAX_DEPTH; d++) {
+				auto &buf = by_depth[d];
+				auto &ix = index[d];
+				if (buf.size() != ix[end] - ix[start]) {
+					std::cerr << "solution counts do not match headers at coset " << start << "\n";
+					failed = true;
+				} else if (!buf.empty()) {
+					size_t offset = records_offset +
+						(fh.depth_start[d] + ix[start]) * sizeof(tracker::solution);
+					if (!pwrite_all(&buf[0], buf.size() * sizeof(tracker::solution), offset)) {
+						perror(tmp.c_str());
+						failed = true;
+					}
+				}
+				buf.clear();
+			}
+		}
+	});
+
+	workers.join();
+
+	ok = !failed && fdatasync(fd) == 0;
+	::close(fd);
+
+	std::error_code ec;
+	if (ok) {
+		std::filesystem::rename(tmp, path, ec);
+	} else {
+		std::filesystem::remove(tmp, ec);
+	}
+	return ok && !ec;
+}
+
+bool solution_file::open(const std::string &path) {
+	std::error_code ec;
+	size_t size = std::filesystem::file_size(path, ec);
+	if (ec || size < sizeof(file_header)) {
+		return false;
+	}
+
+	auto [ mem, fd ] = alloc::mmap_file<uint8_t>(size, path, true);
+	if (!mem) {
+		return false;
+	}
+
+	::close(fd);
+
+	h = (const file_header *) mem;
+	if (h->magic != MAGIC || h->n_cosets != N_EDGE_INVO || file_size(h->n_solutions) != size) {
+		std::cerr << "invalid solution file " << path << "\n";
+		munmap(mem, size);
+		h = NULL;
+		return false;
+	}
+
+	head = (const tracker::header *) &h[1];
+	index = (const index_t *) &head[N_EDGE_INVO];
+	records = (const tracker::solution *) &index[MAX_DEPTH + 1];
+
+	return true;
+}
@@ -0,0 +1,66 @@
+#ifndef INVL_SOLUTION_FILE_H
+#define INVL_SOLUTION_FILE_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include "tracker.h"
+
+// binary export of all solutions, for mapping read-only by other programs
+// - file header, then the coset headers as in invo.dat
+// - then for each depth, the index of each coset's first record within
+//   that depth, N_EDGE_INVO + 1 entries per depth
+// - then the packed records, sorted by depth and then by coset
+
+class solution_file {
+	static constexpr uint64_t MAGIC = 0x31766e6f69746c73;
+
+	struct file_header {
+		uint64_t magic;
+		uint64_t n_cosets;
+		uint64_t n_solutions;
+		// first record of each depth, and the end of the records
+		uint64_t depth_start[MAX_DEPTH + 2];
+	};
+
+	using index_t = std::array<uint32_t, N_EDGE_INVO + 1>;
+
+    public:
+	// needs an open tracker
+	static bool write(const std::string &path);
+
+	bool open(const std::string &path);
+
+	std::span<const tracker::header> headers() const {
+		return { head, N_EDGE_INVO };
+	}
+
+	// all solutions of a depth
+	std::span<const tracker::solution> solutions(int depth) const {
+		auto first = &records[h->depth_start[depth]];
+		return { first, h->depth_start[depth + 1] - h->depth_start[depth] };
+	}
+
+	// solutions of a depth in one coset
+	std::span<const tracker::solution> solutions(int depth, int idx) const {
+		auto &ix = index[depth];
+		return solutions(depth).subspan(ix[idx], ix[idx + 1] - ix[idx]);
+	}
+
+	size_t size() const {
+		return h->n_solutions;
+	}
+
+    private:
+	static size_t file_size(size_t n_solutions) {
+		return sizeof(file_header) + N_EDGE_INVO * sizeof(tracker::header) +
+			(MAX_DEPTH + 1) * sizeof(index_t) + n_solutions * sizeof(tracker::solution);
+	}
+
+	const file_header *h = NULL;
+	const tracker::header *head = NULL;
+	const index_t *index = NULL;
+	const tracker::solution *records = NULL;
+};
+
+#endif
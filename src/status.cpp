@@ -8,35 +8,53 @@
 using namespace std::chrono_literals;
 
 void status::show_counts() {
+	show_counts(tracker::depth_counts(), NULL);
+}
+
+void status::show_counts(const counts_t &counts, const double *rates) {
 	static const std::vector<size_t> expected = {
 		1, 1, 1, 2, 4, 25, 41, 292, 506, 3501, 7741, 45543,
 		146698, 700019, 3500419, 19478862, 130385528, 778842829,
 		2184417694, 445145591, 10842
 	};
 
-	size_t counts[MAX_DEPTH + 1] = {};
-
-	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
-		auto h = tracker::get_header(idx);
-		for (int d = 0; d <= MAX_DEPTH; d++) {
-			counts[d] += h.n_length[d];
-		}
-	}
-
 	for (int d = 0; d <= MAX_DEPTH; d++) {
-		std::cout << std::format(
-			"{:2} {:10} / {}\n", d, counts[d], expected[d]);
+		if (rates) {
+			std::cout << std::format(
+				"{:2} {:10} / {:10} {:10.1f}/s\n", d, counts[d], expected[d], rates[d]);
+		} else {
+			std::cout << std::format(
+				"{:2} {:10} / {}\n", d, counts[d], expected[d]);
+		}
 	}
 }
 
 void status::status_thread() {
 	std::unique_lock lock(mtx);
 
+	auto last = tracker::depth_counts();
+	auto last_time = std::chrono::steady_clock::now();
+	bool first = true;
+
 	auto show_status = [&]() {
 		size_t idx = progress;
 		lock.unlock();
+
+		auto counts = tracker::depth_counts();
+		auto now = std::chrono::steady_clock::now();
+		double seconds = std::chrono::duration<double>(now - last_time).count();
+
+		double rates[MAX_DEPTH + 1];
+		for (int d = 0; d <= MAX_DEPTH; d++) {
+			rates[d] = (counts[d] - last[d]) / seconds;
+		}
+
 		std::cout << std::format("\nCosets: {}/{}\n", idx, total);
-		show_counts();
+		show_counts(counts, first ? NULL : rates);
+
+		last = counts;
+		last_time = now;
+		first = false;
 		lock.lock();
 	};
 
@@ -1,7 +1,9 @@
 #ifndef INVL_STATUS_H
 #define INVL_STATUS_H
 
+#include <array>
 #include "thread.h"
+#include "tracker.h"
 
 class status {
 	std::mutex mtx;
@@ -29,6 +31,11 @@ class status {
 	static void show_counts();
 
     private:
+	using counts_t = std::array<size_t, MAX_DEPTH + 1>;
+
+	// with solves per second by depth when rates are given
+	static void show_counts(const counts_t &counts, const double *rates);
+
 	void status_thread();
 };
 
@@ -45,6 +45,16 @@ namespace tables {
 			f.flush() && rename(tmp, path);
 	}
 
+	template<class H, class T>
+	static bool save(std::string filename, const H &header, const T *table, size_t size) {
+		auto path = full_path(filename);
+		auto tmp = path + ".tmp";
+		std::ofstream f(tmp, std::ofstream::binary);
+		return f && f.write((const char *) &header, sizeof(header)) &&
+			f.write((const char *) table, size * sizeof(*table)) &&
+			f.flush() && rename(tmp, path);
+	}
+
 	template<class T>
 	static bool save_and_extend(std::string filename, const T *table, size_t size, size_t full_size) {
 		auto path = full_path(filename);
@@ -1,6 +1,14 @@
 #include <iostream>
+#include <fstream>
+#include <cstring>
+#include <atomic>
+#include <immintrin.h>
 #include <filesystem>
-#include <sys/file.h>
+#include <chrono>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <cerrno>
+#include <unistd.h>
 #include "tracker.h"
 #include "involution.h"
 #include "eprune.h"
@@ -8,6 +16,7 @@
 #include "tables.h"
 #include "corner_hash.h"
 #include "alloc.h"
+#include "ecindex.h"
 
 void tracker::init() {
 	static std::once_flag flag;
@@ -15,14 +24,19 @@ void tracker::init() {
 		involution::init();
 
 		ec_mutex = new std::mutex[N_EDGE_INVO]{};
-		corner_sets = new std::bitset<65536>[N_EDGE_INVO]{};
+		corner_sets = new corner_set[N_EDGE_INVO]{};
 		is_initialized = new uint8_t[N_EDGE_INVO]{};
+		dirty = new uint8_t[N_EDGE_INVO]{};
+		synced = new uint16_t[N_EDGE_INVO]{};
 
 		auto corners = involution::corners();
 		for (int parity = 0; parity < 2; parity++) {
 			auto corner_set = &corner_init[parity];
+			corner_inv[parity].resize(N_CORNER_HASH);
 			for (auto cc : corners[parity]) {
-				corner_set->set(corner_hash(cc));
+				auto hash = corner_hash(cc);
+				corner_set->set(hash);
+				corner_inv[parity][hash] = cc;
 			}
 		}
 	});
@@ -47,6 +61,7 @@ void tracker::create() {
 	auto edges = involution::edges();
 
 	std::vector<header> head(N_EDGE_INVO);
+	std::vector<ecoord> cosets;
 
 	uint32_t offset = 0, idx = 0;
 
@@ -63,13 +78,14 @@ void tracker::create() {
 			h.n_cubes = involution::cube_count(ec);
 			h.n_solved = 0;
 			h.n_length = {};
-			h._reserved0 = 0;
+			h.seq = 0;
 			h.proven_min = prune;
 			h.parity = parity;
 			h.prune = prune;
 			h._reserved1 = 0;
 
 			offset += h.n_cubes;
+			cosets.push_back(ec);
 		}
 	}
 
@@ -78,35 +94,544 @@ void tracker::create() {
 		abort();
 	}
 	std::filesystem::resize_file(tables::full_path(tmp), file_size());
+
+	if (!ecindex::create(cosets)) {
+		std::cerr << "Error writing coset index.\n";
+		abort();
+	}
+
 	std::filesystem::rename(tables::full_path(tmp), tables::full_path(path));
 }
 
-bool tracker::open() {
+bool tracker::open(bool hugepages) {
+	// leases as of the headers and slots read here; a range is read again
+	// when claimed only if its lease changed since
+	seen = new lease[N_LEASE]{};
+	std::ifstream(tables::full_path(LEASE_FILE), std::ifstream::binary)
+		.read((char *) seen, N_LEASE * sizeof(lease));
+
 	std::string path = tables::full_path(TRACKER_FILE);
-	auto [ mem, fd_ ] = alloc::mmap_file<uint8_t>(file_size(), path);
+	size_t head_size = N_EDGE_INVO * sizeof(header);
+	if (hugepages) {
+		// solution slots only; checkpoints write them back with pwrite
+		auto [ mem, fd_ ] = alloc::huge_file<solution>(N_INVO, path, head_size);
+		if (!mem) return false;
+		fd = fd_;
+		sol = mem;
+		in_memory = true;
+	} else {
+		auto [ mem, fd_ ] = alloc::mmap_file<uint8_t>(file_size(), path);
+		if (!mem) return false;
+		fd = fd_;
+		sol = (solution *) &mem[head_size];
+	}
+	if (!read_headers()) {
+		perror("pread");
+		return false;
+	}
+	open_unsolved();
+	count_depths();
+	return true;
+}
+
+// the file's header for idx, retried while a checkpoint is writing it
+static tracker::header read_header(const tracker::header &h) {
+	auto &seq = const_cast<uint32_t &>(h.seq);
+	for (int spin = 0; ; spin++) {
+		// a writer killed mid-checkpoint leaves seq odd until its ranges
+		// are taken over; the header itself was written with one pwrite
+		uint32_t s0 = std::atomic_ref(seq).load(std::memory_order_acquire);
+		if ((s0 & 1) && spin < (1 << 20)) {
+			_mm_pause();
+			continue;
+		}
+		tracker::header copy;
+		memcpy(&copy, &h, sizeof(copy));
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (std::atomic_ref(seq).load(std::memory_order_relaxed) == s0) {
+			return copy;
+		}
+	}
+}
+
+// bytes of the lease file: byte 0 is held while leases are changed, and
+// byte 1 + r by the owner of range r for as long as it owns it, so the
+// kernel drops the leases of a process that dies
+static bool lock_range(int fd, short type, off_t start, int cmd = F_OFD_SETLK) {
+	struct flock fl = {};
+	fl.l_type = type;
+	fl.l_whence = SEEK_SET;
+	fl.l_start = start;
+	fl.l_len = 1;
+	return fcntl(fd, cmd, &fl) == 0;
+}
+
+tracker::depth_shard & tracker::thread_shard() {
+	static std::atomic<size_t> next_shard = 0;
+	thread_local size_t shard = next_shard++ % N_DEPTH_SHARDS;
+	return depth_shards[shard];
+}
+
+void tracker::add_depths(const header &h, int sign) {
+	auto &shard = thread_shard();
+	for (int d = 0; d <= MAX_DEPTH; d++) {
+		shard.n[d].fetch_add(sign * h.n_length[d], std::memory_order_relaxed);
+	}
+}
+
+void tracker::count_depths() {
+	for (auto &shard : depth_shards) {
+		for (auto &n : shard.n) {
+			n = 0;
+		}
+	}
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		add_depths(head[idx], 1);
+	}
+}
+
+std::array<size_t, MAX_DEPTH + 1> tracker::depth_counts() {
+	std::array<size_t, MAX_DEPTH + 1> counts = {};
+	for (auto &shard : depth_shards) {
+		for (int d = 0; d <= MAX_DEPTH; d++) {
+			counts[d] += shard.n[d].load(std::memory_order_relaxed);
+		}
+	}
+	return counts;
+}
+
+std::string tracker::journal_path(int pid) {
+	return tables::full_path(std::string(JOURNAL_FILE) + "." + std::to_string(pid));
+}
+
+bool tracker::open_readonly() {
+	std::string path = tables::full_path(TRACKER_FILE);
+	auto [ mem, fd_ ] = alloc::mmap_file<uint8_t>(file_size(), path, true);
 	if (!mem) return false;
 	fd = fd_;
-	head = (header *) &mem[0];
-	sol = (solution *) &head[N_EDGE_INVO];
+
+	// no lock: writers lease cosets through invo.lease, and headers are
+	// read through their seqlock
+
+	// scans read the slots front to back; headers are read right away
+	size_t head_size = N_EDGE_INVO * sizeof(header);
+	madvise(mem, file_size(), MADV_SEQUENTIAL);
+	madvise(mem, head_size, MADV_WILLNEED);
+
+	auto file_head = (const header *) mem;
+	head = new header[N_EDGE_INVO];
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		head[idx] = read_header(file_head[idx]);
+	}
+
+	sol = (solution *) &mem[head_size];
+	open_unsolved();
+	count_depths();
 	return true;
 }
 
+// a work unit: headers, solutions and unsolved sets of the cosets from
+// start, with slots for those cosets only and nothing written to disk
+void tracker::open_memory(size_t start, const std::vector<header> &headers,
+		const std::vector<solution> &solutions, std::vector<corner_set> &&sets) {
+	size_t n_slots = 0;
+	for (auto &h : headers) {
+		n_slots += h.n_cubes;
+	}
+
+	head = new header[N_EDGE_INVO]{};
+	sol = new solution[n_slots]{};
+	in_memory = true;
+
+	size_t offset = 0;
+	auto s = solutions.begin();
+	for (size_t i = 0; i < headers.size(); i++) {
+		auto idx = start + i;
+		auto &h = head[idx] = headers[i];
+		h.offset = offset;
+		std::copy(s, s + h.n_solved, &sol[offset]);
+		s += h.n_solved;
+		offset += h.n_cubes;
+
+		if (i < sets.size()) {
+			corner_sets[idx] = std::move(sets[i]);
+			is_initialized[idx] = 1;
+		}
+	}
+	count_depths();
+}
+
+// frees what open_memory allocated
+void tracker::close_memory() {
+	delete[] head;
+	delete[] sol;
+	head = NULL;
+	sol = NULL;
+	in_memory = false;
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		corner_sets[idx] = {};
+		is_initialized[idx] = 0;
+	}
+}
+
+void tracker::close() {
+	if (writeback.joinable()) {
+		{
+			std::unique_lock lock(writeback_mtx);
+			writeback_done = true;
+		}
+		writeback_cv.notify_all();
+		writeback.join();
+		checkpoint();
+		unlock();
+	}
+
+	if (!save_unsolved()) {
+		std::cerr << "Error writing unsolved sets.\n";
+	}
+	if (counts && !save_counts()) {
+		std::cerr << "Error writing symmetry counts.\n";
+	}
+}
+
+bool tracker::read_headers() {
+	if (!head) {
+		head = new header[N_EDGE_INVO];
+	}
+	size_t n = N_EDGE_INVO * sizeof(header);
+	return pread(fd, head, n, 0) == n;
+}
+
+bool tracker::write_headers(std::vector<journal_entry> &entries) {
+	// seqlock for open_readonly: seq is odd while the header is written
+	for (auto &e : entries) {
+		off_t off = e.idx * sizeof(header);
+		off_t off_seq = off + offsetof(header, seq);
+		uint32_t seq = e.h.seq | 1;
+		e.h.seq = seq;
+		if (pwrite(fd, &seq, sizeof(seq), off_seq) != sizeof(seq) ||
+				pwrite(fd, &e.h, sizeof(header), off) != sizeof(header)) {
+			return false;
+		}
+		e.h.seq = ++seq;
+		if (pwrite(fd, &seq, sizeof(seq), off_seq) != sizeof(seq)) {
+			return false;
+		}
+		head[e.idx].seq = seq;
+	}
+	return fdatasync(fd) == 0;
+}
+
+static uint64_t journal_checksum(const void *data, size_t n) {
+	// FNV-1a
+	auto p = (const uint8_t *) data;
+	uint64_t hash = 0xcbf29ce484222325;
+	for (size_t i = 0; i < n; i++) {
+		hash = (hash ^ p[i]) * 0x100000001b3;
+	}
+	return hash;
+}
+
+void tracker::replay_journal(int pid) {
+	auto path = journal_path(pid);
+	std::ifstream f(path, std::ifstream::binary);
+	journal_header jh;
+	if (!f || !f.read((char *) &jh, sizeof(jh))) {
+		return;
+	}
+
+	std::vector<journal_entry> entries;
+	if (jh.magic == JOURNAL_MAGIC && jh.count <= N_EDGE_INVO) {
+		entries.resize(jh.count);
+		f.read((char *) &entries[0], jh.count * sizeof(journal_entry));
+	}
+
+	size_t n = entries.size() * sizeof(journal_entry);
+	if (!f || entries.empty() || journal_checksum(&entries[0], n) != jh.checksum) {
+		// torn journal: the checkpoint never got to the headers
+		std::cerr << "discarding incomplete journal\n";
+	} else {
+		std::cerr << "replaying journal: " << entries.size() << " headers\n";
+		if (!write_headers(entries)) {
+			perror("write_headers");
+			abort();
+		}
+		for (auto &e : entries) {
+			add_depths(head[e.idx], -1);
+			head[e.idx] = e.h;
+			add_depths(e.h, 1);
+		}
+	}
+
+	f.close();
+	std::filesystem::remove(path);
+}
+
+void tracker::checkpoint() {
+	std::unique_lock lock(checkpoint_mtx);
+
+	// cosets held by a worker stay dirty until the next checkpoint
+	std::vector<journal_entry> entries;
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		if (!ec_mutex[idx].try_lock()) {
+			continue;
+		}
+		if (dirty[idx]) {
+			entries.push_back({ uint32_t(idx), 0, head[idx] });
+			dirty[idx] = 0;
+		}
+		ec_mutex[idx].unlock();
+	}
+
+	if (entries.empty()) {
+		return;
+	}
+
+	// solution slots before the headers that count them
+	for (auto &e : entries) {
+		size_t begin = e.h.offset + synced[e.idx], end = e.h.offset + e.h.n_solved;
+		if (begin >= end) {
+			continue;
+		}
+		off_t off = N_EDGE_INVO * sizeof(header) + begin * sizeof(solution);
+		size_t len = (end - begin) * sizeof(solution);
+		if (!in_memory) {
+			sync_file_range(fd, off, len, SYNC_FILE_RANGE_WRITE);
+		} else if (pwrite(fd, &sol[begin], len, off) != len) {
+			perror("pwrite");
+			abort();
+		}
+	}
+	if (fdatasync(fd) != 0) {
+		perror("fdatasync");
+		abort();
+	}
+
+	auto path = journal_path(getpid());
+	int jfd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (jfd == -1) {
+		perror("open journal");
+		abort();
+	}
+
+	size_t n = entries.size() * sizeof(journal_entry);
+	journal_header jh = { JOURNAL_MAGIC, entries.size(), journal_checksum(&entries[0], n), 0 };
+	if (write(jfd, &jh, sizeof(jh)) != sizeof(jh) || write(jfd, &entries[0], n) != n ||
+			fdatasync(jfd) != 0) {
+		perror("write journal");
+		abort();
+	}
+
+	if (!write_headers(entries)) {
+		perror("write_headers");
+		abort();
+	}
+
+	if (ftruncate(jfd, 0) != 0 || fdatasync(jfd) != 0) {
+		perror("truncate journal");
+		abort();
+	}
+	::close(jfd);
+
+	for (auto &e : entries) {
+		synced[e.idx] = e.h.n_solved;
+	}
+}
+
+void tracker::writeback_thread() {
+	std::unique_lock lock(writeback_mtx);
+	while (!writeback_done) {
+		writeback_cv.wait_for(lock, std::chrono::seconds(CHECKPOINT_SECONDS));
+		if (!writeback_done) {
+			lock.unlock();
+			checkpoint();
+			release_idle();
+			lock.lock();
+		}
+	}
+}
+
+void tracker::open_index() {
+	if (ecindex::open()) {
+		return;
+	}
+
+	// databases created before the index existed
+	std::cerr << "building coset index\n";
+	std::vector<ecoord> cosets;
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		cosets.push_back(head[idx].get_ec());
+	}
+	if (!ecindex::create(cosets) || !ecindex::open()) {
+		std::cerr << "Error writing coset index.\n";
+		abort();
+	}
+}
+
 void tracker::lock() {
-	if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
-		perror("flock(LOCK_EX)");
+	auto path = tables::full_path(LEASE_FILE);
+	size_t size = N_LEASE * sizeof(lease);
+	lease_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+	if (lease_fd == -1 || ftruncate(lease_fd, size) != 0) {
+		perror(path.c_str());
 		abort();
 	}
+
+	leases = (lease *) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, lease_fd, 0);
+	if (leases == MAP_FAILED) {
+		perror("mmap");
+		abort();
+	}
+	owned = new std::atomic<uint8_t>[N_LEASE]{};
+	claims = new std::atomic<uint32_t>[N_LEASE]{};
+
+	// left by an earlier process that had our pid
+	replay_journal(getpid());
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		synced[idx] = head[idx].n_solved;
+	}
+
+	open_counts();
+
+	writeback_done = false;
+	writeback = std::thread(writeback_thread);
 }
 
 void tracker::unlock() {
-	if (flock(fd, LOCK_UN) != 0) {
-		perror("flock(LOCK_UN)");
+	std::unique_lock lock(lease_mtx);
+	lock_range(lease_fd, F_WRLCK, 0, F_OFD_SETLKW);
+	for (size_t r = 0; r < N_LEASE; r++) {
+		if (owned[r]) {
+			leases[r].pid = 0;
+			seen[r].generation = ++leases[r].generation;
+			lock_range(lease_fd, F_UNLCK, 1 + r);
+			owned[r] = 0;
+		}
+	}
+	lock_range(lease_fd, F_UNLCK, 0);
+	std::filesystem::remove(journal_path(getpid()));
+}
+
+bool tracker::claim(int idx) {
+	// counted before owned is checked, as release_idle() does the reverse
+	size_t r = idx / LEASE_COSETS;
+	claims[r]++;
+	if (owned[r]) {
+		return true;
+	}
+
+	std::unique_lock lock(lease_mtx);
+	if (owned[r]) {
+		return true;
+	}
+
+	// owned by a running process
+	if (!lock_range(lease_fd, F_WRLCK, 1 + r)) {
+		if (errno != EAGAIN && errno != EACCES) {
+			perror("fcntl(F_WRLCK)");
+			abort();
+		}
+		claims[r]--;
+		return false;
+	}
+
+	if (!lock_range(lease_fd, F_WRLCK, 0, F_OFD_SETLKW)) {
+		perror("fcntl(F_WRLCK)");
+		abort();
+	}
+
+	// an owner that died left its pid; redo its last checkpoint, which
+	// covers all its ranges
+	auto &l = leases[r];
+	int self = getpid(), prev = l.pid;
+	if (prev != 0 && prev != self) {
+		replay_journal(prev);
+	}
+
+	// an owner since we opened may have changed these cosets
+	if (prev != 0 || l.generation != seen[r].generation) {
+		read_range(r);
+	}
+	l.pid = self;
+	seen[r].generation = ++l.generation;
+
+	owned[r] = 1;
+	lock_range(lease_fd, F_UNLCK, 0);
+	return true;
+}
+
+void tracker::release(int idx) {
+	claims[idx / LEASE_COSETS]--;
+}
+
+// gives up the leases of ranges with no claims and no coset changed since
+// the last checkpoint; called after a checkpoint
+void tracker::release_idle() {
+	std::unique_lock lock(lease_mtx);
+	bool locked = false;
+	for (size_t r = 0; r < N_LEASE; r++) {
+		if (!owned[r] || claims[r]) {
+			continue;
+		}
+
+		owned[r] = 0;
+		size_t start = r * LEASE_COSETS, end = std::min(start + LEASE_COSETS, N_EDGE_INVO);
+		bool idle = claims[r] == 0 && std::none_of(&dirty[start], &dirty[end],
+			[](uint8_t d) { return d != 0; });
+		if (!idle) {
+			owned[r] = 1;
+			continue;
+		}
+
+		if (!locked && !lock_range(lease_fd, F_WRLCK, 0, F_OFD_SETLKW)) {
+			perror("fcntl(F_WRLCK)");
+			abort();
+		}
+		locked = true;
+		leases[r].pid = 0;
+		seen[r].generation = ++leases[r].generation;
+		lock_range(lease_fd, F_UNLCK, 1 + r);
+	}
+	if (locked) {
+		lock_range(lease_fd, F_UNLCK, 0);
+	}
+}
+
+// reads the headers of range r again, and its slots when in memory
+void tracker::read_range(size_t r) {
+	size_t start = r * LEASE_COSETS, end = std::min(start + LEASE_COSETS, N_EDGE_INVO);
+	std::vector<header> before(&head[start], &head[end]);
+	size_t n = (end - start) * sizeof(header);
+	if (pread(fd, &head[start], n, start * sizeof(header)) != n) {
+		perror("pread");
 		abort();
 	}
+	if (in_memory) {
+		size_t first = head[start].offset;
+		size_t last = head[end - 1].offset + head[end - 1].n_cubes;
+		off_t off = N_EDGE_INVO * sizeof(header) + first * sizeof(solution);
+		n = (last - first) * sizeof(solution);
+		if (pread(fd, &sol[first], n, off) != n) {
+			perror("pread");
+			abort();
+		}
+	}
+	for (size_t idx = start; idx < end; idx++) {
+		add_depths(before[idx - start], -1);
+		add_depths(head[idx], 1);
+		synced[idx] = head[idx].n_solved;
+		is_initialized[idx] = false;
+		if (counts && head[idx].n_length != before[idx - start].n_length) {
+			counts[idx].n_solved = UINT32_MAX;
+		}
+	}
 }
 
 void tracker::reset(int idx) {
 	auto &h = head[idx];
+	add_depths(h, -1);
 	h.n_solved = 0;
 	h.n_length = {};
 	h.proven_min = h.prune;
@@ -118,26 +643,253 @@ void tracker::reset(int idx) {
 
 	is_initialized[idx] = false;
 	corner_sets[idx] = {};
+	dirty[idx] = 1;
+
+	if (counts) {
+		counts[idx] = {};
+	}
+}
+
+void tracker::solution_cubes(int idx, std::vector<cube> &cubes) {
+	auto solutions = tracker::solutions(idx);
+	cubes.resize(solutions.size());
+	for (size_t i = 0; i < solutions.size(); i++) {
+		cubes[i] = solutions[i].to_cube();
+	}
+}
+
+// unsolved sets are stored as a sorted array of hashes while that is
+// smaller than the dense bitmap
+static size_t unsolved_bytes(size_t count) {
+	size_t dense = corner_set::N_WORDS * sizeof(uint64_t);
+	return std::min(count * sizeof(uint16_t), dense);
 }
 
-std::vector<moveseq> tracker::get_solutions(int idx) {
-	std::vector<moveseq> solutions;
+static bool is_dense(size_t count) {
+	return count >= corner_set::SPARSE_MAX;
+}
+
+uint32_t tracker::last_solution(int idx) {
 	auto &h = head[idx];
-	uint32_t n_solved = h.n_solved, offset = h.offset;
-	for (int i = 0; i < n_solved; i++) {
-		solutions.push_back(sol[offset++]);
+	if (h.n_solved == 0) {
+		return 0;
+	}
+
+	// FNV-1a of the last stored solution
+	auto s = (const uint8_t *) &sol[h.offset + h.n_solved - 1];
+	uint32_t hash = 0x811c9dc5;
+	for (size_t i = 0; i < sizeof(solution); i++) {
+		hash = (hash ^ s[i]) * 0x01000193;
+	}
+	return hash;
+}
+
+bool tracker::open_unsolved() {
+	auto path = tables::full_path(UNSOLVED_FILE);
+
+	std::error_code ec;
+	size_t file_size = std::filesystem::file_size(path, ec);
+	size_t dir_size = sizeof(unsolved_header) + N_EDGE_INVO * sizeof(unsolved_entry);
+	if (ec || file_size < dir_size) {
+		return false;
+	}
+
+	auto [ mem, fd_ ] = alloc::mmap_file<uint8_t>(file_size, path, true);
+	if (!mem) {
+		return false;
+	}
+
+	::close(fd_);
+
+	auto h = (const unsolved_header *) mem;
+	if (h->magic != UNSOLVED_MAGIC || h->n_cosets != N_EDGE_INVO || dir_size + h->size != file_size) {
+		std::cerr << "ignoring invalid unsolved sets " << path << "\n";
+		return false;
+	}
+
+	unsolved_dir = (const unsolved_entry *) &h[1];
+	unsolved_data = (const uint8_t *) &unsolved_dir[N_EDGE_INVO];
+	unsolved_size = h->size;
+
+	return true;
+}
+
+const tracker::unsolved_entry * tracker::cached_unsolved(int idx) {
+	if (!unsolved_dir) {
+		return NULL;
+	}
+
+	auto &e = unsolved_dir[idx];
+	if (e.n_solved != head[idx].n_solved || e.last != last_solution(idx) ||
+			e.offset + unsolved_bytes(e.count) > unsolved_size) {
+		return NULL;
+	}
+
+	return &e;
+}
+
+bool tracker::save_unsolved() {
+	std::vector<unsolved_entry> dir(N_EDGE_INVO);
+	uint64_t offset = 0;
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		auto &e = dir[idx];
+
+		// cosets not touched by this run keep their previous entry
+		size_t count;
+		if (is_initialized[idx]) {
+			count = corner_sets[idx].count();
+		} else if (auto old = cached_unsolved(idx)) {
+			count = old->count;
+		} else {
+			e.n_solved = UINT32_MAX;
+			continue;
+		}
+
+		e.n_solved = head[idx].n_solved;
+		e.last = last_solution(idx);
+		e.count = count;
+	}
+
+	// bitmaps first so they stay 8-byte aligned in the mapping
+	for (int pass = 0; pass < 2; pass++) {
+		for (auto &e : dir) {
+			if (e.n_solved != UINT32_MAX && is_dense(e.count) == (pass == 0)) {
+				e.offset = offset;
+				offset += unsolved_bytes(e.count);
+			}
+		}
+	}
+
+	auto path = tables::full_path(UNSOLVED_FILE);
+	auto tmp = path + "." + std::to_string(getpid()) + ".tmp";
+	std::ofstream f(tmp, std::ofstream::binary);
+
+	unsolved_header h = { UNSOLVED_MAGIC, N_EDGE_INVO, offset };
+	f.write((const char *) &h, sizeof(h));
+	f.write((const char *) &dir[0], N_EDGE_INVO * sizeof(unsolved_entry));
+
+	std::vector<uint16_t> hashes;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int idx = 0; idx < N_EDGE_INVO && f; idx++) {
+			auto &e = dir[idx];
+			if (e.n_solved == UINT32_MAX || is_dense(e.count) != (pass == 0)) {
+				continue;
+			}
+
+			if (!is_initialized[idx]) {
+				auto old = cached_unsolved(idx);
+				f.write((const char *) &unsolved_data[old->offset], unsolved_bytes(e.count));
+			} else if (is_dense(e.count)) {
+				f.write((const char *) corner_sets[idx].words(), unsolved_bytes(e.count));
+			} else {
+				hashes.clear();
+				corner_sets[idx].for_each([&](uint16_t hash) {
+					hashes.push_back(hash);
+				});
+				f.write((const char *) hashes.data(), unsolved_bytes(e.count));
+			}
+		}
+	}
+
+	if (!f || !f.flush()) {
+		return false;
+	}
+	f.close();
+
+	std::error_code ec;
+	std::filesystem::rename(tmp, path, ec);
+	return !ec;
+}
+
+bool tracker::open_counts() {
+	counts = new count_entry[N_EDGE_INVO];
+
+	count_header h;
+	std::ifstream f(tables::full_path(COUNT_FILE), std::ifstream::binary);
+	bool ok = f.read((char *) &h, sizeof(h)) && h.magic == COUNT_MAGIC &&
+		h.n_cosets == N_EDGE_INVO &&
+		f.read((char *) counts, N_EDGE_INVO * sizeof(count_entry));
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		auto &e = counts[idx];
+		if (head[idx].n_solved == 0) {
+			e = {};
+		} else if (!ok || e.n_solved != head[idx].n_solved || e.last != last_solution(idx)) {
+			e.n_solved = UINT32_MAX;
+		}
+	}
+
+	return ok;
+}
+
+// counts of a coset not in the file, from its stored solutions
+void tracker::count_solutions(int idx) {
+	if (!counts || counts[idx].n_solved != UINT32_MAX) {
+		return;
+	}
+
+	auto &e = counts[idx];
+	e.n_length = {};
+	auto self_sym = head[idx].get_ec().selfsym();
+	for (auto &sol : solutions(idx)) {
+		cube c = sol.to_cube();
+		uint64_t self = 1;
+		for (auto s : bits(self_sym)) {
+			if (c.symi(s) == c) {
+				self |= 1ULL << s;
+			}
+		}
+		e.n_length[sol.length()] += N_SYM48 / std::popcount(self);
 	}
-	return solutions;
+	e.n_solved = 0;
 }
 
-std::bitset<65536> * tracker::get_corner_set(int idx) {
+bool tracker::save_counts() {
+	std::vector<count_entry> entries(&counts[0], &counts[N_EDGE_INVO]);
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		auto &e = entries[idx];
+		if (e.n_solved != UINT32_MAX) {
+			e.n_solved = head[idx].n_solved;
+			e.last = last_solution(idx);
+		}
+	}
+
+	auto path = tables::full_path(COUNT_FILE);
+	auto tmp = path + "." + std::to_string(getpid()) + ".tmp";
+	std::ofstream f(tmp, std::ofstream::binary);
+
+	count_header h = { COUNT_MAGIC, N_EDGE_INVO };
+	f.write((const char *) &h, sizeof(h));
+	f.write((const char *) &entries[0], N_EDGE_INVO * sizeof(count_entry));
+	if (!f || !f.flush()) {
+		return false;
+	}
+	f.close();
+
+	return tables::rename(tmp, path);
+}
+
+corner_set * tracker::get_corner_set(int idx) {
 	auto corner_set = &corner_sets[idx];
 	if (!is_initialized[idx]) {
 		auto &h = head[idx];
+		if (auto e = cached_unsolved(idx)) {
+			auto data = &unsolved_data[e->offset];
+			if (is_dense(e->count)) {
+				*corner_set = ::corner_set::from_words((const uint64_t *) data);
+			} else {
+				*corner_set = ::corner_set::from_sorted((const uint16_t *) data, e->count);
+			}
+			is_initialized[idx] = 1;
+			return corner_set;
+		}
+
 		*corner_set = corner_init[h.parity];
 		auto self_sym = ecoord(h.ep, h.eo).selfsym();
-		for (const auto &moves : get_solutions(idx)) {
-			cube c = cube::from_moveseq(moves);
+		std::vector<cube> cubes;
+		solution_cubes(idx, cubes);
+		for (auto &c : cubes) {
 			corner_set->reset(corner_hash(c));
 			for (auto s : bits(self_sym)) {
 				auto c_s = c.symi(s);
@@ -173,8 +925,15 @@ tracker::solution::solution(moveseq seq) : solution() {
 }
 
 tracker::solution::operator moveseq () const {
+	uint8_t moves[MAX_DEPTH];
+	int len = decode(moves);
+	return moveseq(moves, moves + len);
+}
+
+int tracker::solution::decode(uint8_t *out) const {
 	int len = length();
-	moveseq seq;
+	if (len > MAX_DEPTH) abort();
+
 	uint8_t last_axis = 0xff;
 	for (int i = 0; i < len; i++) {
 		uint8_t m = moves[i / 2];
@@ -192,9 +951,9 @@ tracker::solution::operator moveseq () const {
 			axis++;
 		}
 		last_axis = axis;
-		seq.push_back(m);
+		out[i] = m;
 	}
-	return seq;
+	return len;
 }
 
 bool tracker::handle::solution(const moveseq &seq) {
@@ -203,25 +962,42 @@ bool tracker::handle::solution(const moveseq &seq) {
 }
 
 bool tracker::handle::solution(moveseq seq, cube c, int hash) {
-	if (!corner_set->test(hash)) {
+	if (!corner_set->reset(hash)) {
 		return false;
 	}
 
-	corner_set->reset(hash);
 	todo--;
 
+	std::array<cube, N_SYM48> images;
+	std::array<uint16_t, N_SYM48> hashes;
+	size_t n = 0;
 	for (auto s : bits(self_sym)) {
-		auto h_s = corner_hash(c.symi(s));
-		if (corner_set->test(h_s)) {
-			corner_set->reset(h_s);
+		images[n++] = c.symi(s);
+	}
+	corner_hash(&images[0], n, &hashes[0]);
+
+	// images equal to c itself, for the count of all symmetric images
+	uint64_t self = 1;
+	size_t i = 0;
+	for (auto s : bits(self_sym)) {
+		if (corner_set->reset(hashes[i])) {
 			todo--;
 		}
+		if (images[i++] == c) {
+			self |= 1ULL << s;
+		}
 	}
 
 	seq = seq.canonical();
+	// uncounted cosets are left for full_counts()
+	if (counts && counts[idx].n_solved != UINT32_MAX) {
+		counts[idx].n_length[seq.size()] += N_SYM48 / std::popcount(self);
+	}
 	sol[h->offset + h->n_solved] = seq;
 	h->n_solved++;
 	h->n_length[seq.size()]++;
+	thread_shard().n[seq.size()].fetch_add(1, std::memory_order_relaxed);
+	dirty[idx] = 1;
 
 	return true;
 }
@@ -3,10 +3,13 @@
 
 #include <cstdint>
 #include <array>
-#include <bitset>
+#include <atomic>
+#include <span>
 #include "ccoord.h"
 #include "corner_hash.h"
+#include "corner_set.h"
 #include "ecoord.h"
+#include "involution.h"
 #include "moveseq.h"
 #include "thread.h"
 
@@ -14,6 +17,17 @@ constexpr size_t MAX_DEPTH = 20;
 
 class tracker {
 	static constexpr char TRACKER_FILE[] = "invo.dat";
+	static constexpr char UNSOLVED_FILE[] = "invoUnsolved.dat";
+	static constexpr char COUNT_FILE[] = "invoCount.dat";
+	static constexpr uint64_t COUNT_MAGIC = 0x5e2b90c4d17a3f61;
+	static constexpr uint64_t UNSOLVED_MAGIC = 0x83f1e04a6b2c57d9;
+	static constexpr char JOURNAL_FILE[] = "invo.journal";
+	static constexpr uint64_t JOURNAL_MAGIC = 0x4a0c7d2e91b635f8;
+	static constexpr int CHECKPOINT_SECONDS = 30;
+	static constexpr char LEASE_FILE[] = "invo.lease";
+	static constexpr size_t LEASE_COSETS = 4096;
+	static constexpr size_t N_LEASE = (N_EDGE_INVO + LEASE_COSETS - 1) / LEASE_COSETS;
+	static constexpr size_t N_DEPTH_SHARDS = 64;
     public:
 	struct header {
 		uint32_t offset;
@@ -22,7 +36,7 @@ class tracker {
 		uint16_t n_cubes;
 		uint16_t n_solved;
 		std::array<uint16_t, MAX_DEPTH + 1> n_length;
-		uint32_t _reserved0;
+		uint32_t seq;
 		uint8_t proven_min;
 		uint8_t parity;
 		uint8_t prune;
@@ -44,6 +58,15 @@ class tracker {
 
 		operator moveseq () const;
 
+		// writes length() moves to out, at most MAX_DEPTH, returns length()
+		int decode(uint8_t *out) const;
+
+		cube to_cube() const {
+			uint8_t moves[MAX_DEPTH];
+			int n = decode(moves);
+			return cube::from_moves(moves, n);
+		}
+
 		int length() const {
 			return (info & 0b00011111);
 		}
@@ -56,7 +79,7 @@ class tracker {
 	struct handle {
 		uint64_t self_sym;
 		const int idx;
-		std::bitset<65536> *corner_set;
+		::corner_set *corner_set;
 		int todo;
 		header *h;
 
@@ -78,9 +101,23 @@ class tracker {
 			return corner_set->test(corner_hash(cc));
 		}
 
+		bool is_unsolved(const cube &c) {
+			return corner_set->test(corner_hash(c));
+		}
+
+		// calls fn(ccoord) for each unsolved corner state
+		template<typename F>
+		void for_each_unsolved(F fn) const {
+			auto &corners = corner_inv[h->parity];
+			corner_set->for_each([&](uint16_t hash) {
+				fn(corners[hash]);
+			});
+		}
+
 		void update_proven_min(int depth) {
 			if (h->proven_min < depth) {
 				h->proven_min = depth;
+				dirty[idx] = 1;
 			}
 		}
 
@@ -106,31 +143,163 @@ class tracker {
 
 	static void init();
 	static void create();
-	static bool open();
+	static bool open(bool hugepages = false);
+	static bool open_readonly();
+	static void open_memory(size_t start, const std::vector<header> &headers,
+			const std::vector<solution> &solutions, std::vector<corner_set> &&sets);
+	static void close_memory();
+	static void open_index();
+	static bool open_counts();
 	static void lock();
 	static void unlock();
+	// a coset may be changed only between claim() and release(); the
+	// lease of its range is given up at a checkpoint once no claim on the
+	// range is left and its cosets are written back
+	static bool claim(int idx);
+	static void release(int idx);
 	static void reset(int idx);
+	static void close();
+	static void checkpoint();
 
 	static void lock(int idx) { ec_mutex[idx].lock(); }
 	static void unlock(int idx) { ec_mutex[idx].unlock(); }
 
-	static std::vector<moveseq> get_solutions(int idx);
+	// stored solutions of a coset, decoded with solution::decode
+	static std::span<const solution> solutions(int idx) {
+		return { &sol[head[idx].offset], head[idx].n_solved };
+	}
+
+	// the cubes of a coset's stored solutions, in order
+	static void solution_cubes(int idx, std::vector<cube> &cubes);
 
 	static header get_header(int idx) {
 		return head[idx];
 	}
 
+	// solutions by depth in all cosets, as in the headers
+	static std::array<size_t, MAX_DEPTH + 1> depth_counts();
+
+	// solutions of coset idx by depth, counting every symmetric image,
+	// counted from the solutions if not known; needs open_counts() and
+	// no writer on the coset
+	static const std::array<uint32_t, MAX_DEPTH + 1> & full_counts(int idx) {
+		count_solutions(idx);
+		return counts[idx].n_length;
+	}
+
     private:
-	static std::bitset<65536> * get_corner_set(int idx);
+	// unsolved sets of the last run, valid while n_solved and the last
+	// solution still match the header
+	struct unsolved_header {
+		uint64_t magic;
+		uint64_t n_cosets;
+		uint64_t size;
+	};
+
+	struct unsolved_entry {
+		uint32_t n_solved;
+		uint32_t last;
+		uint32_t count;
+		uint32_t _reserved;
+		uint64_t offset;
+	};
+
+	// full symmetry counts of the last run, valid while n_solved and the
+	// last solution still match the header; n_solved is UINT32_MAX in
+	// memory for cosets not counted, which writers leave uncounted and
+	// full_counts() counts from their solutions
+	struct count_header {
+		uint64_t magic;
+		uint64_t n_cosets;
+	};
+
+	struct count_entry {
+		uint32_t n_solved;
+		uint32_t last;
+		std::array<uint32_t, MAX_DEPTH + 1> n_length;
+	};
+
+	static void count_solutions(int idx);
+	static bool save_counts();
+
+	static corner_set * get_corner_set(int idx);
+	static uint32_t last_solution(int idx);
+	static const unsolved_entry * cached_unsolved(int idx);
+	static bool open_unsolved();
+	static bool save_unsolved();
+
+	// headers are written to invo.dat only by checkpoint(), after the
+	// solution slots they count are on disk, via a redo journal
+	struct journal_header {
+		uint64_t magic;
+		uint64_t count;
+		uint64_t checksum;
+		uint64_t _reserved;
+	};
+
+	struct journal_entry {
+		uint32_t idx;
+		uint32_t _reserved;
+		header h;
+	};
+
+	static bool read_headers();
+	static bool write_headers(std::vector<journal_entry> &entries);
+	static std::string journal_path(int pid);
+	static void replay_journal(int pid);
+
+	// owner of each range of LEASE_COSETS cosets, shared by all writers;
+	// the pid is kept after a crash so the next owner replays its journal
+	struct lease {
+		int32_t pid;
+		uint32_t generation;
+	};
+	static void read_range(size_t r);
+	static void release_idle();
+	static void writeback_thread();
+
+	// depth counts as of opening plus the solutions stored since, added
+	// to one shard per thread so writers don't share cache lines
+	struct alignas(64) depth_shard {
+		std::array<std::atomic<uint64_t>, MAX_DEPTH + 1> n;
+	};
+
+	static depth_shard & thread_shard();
+	static void add_depths(const header &h, int sign);
+	static void count_depths();
 
 	inline static int fd = -1;
 	inline static header *head = NULL;
 	inline static solution *sol = NULL;
+	inline static bool in_memory = false;
 	inline static std::mutex *ec_mutex = NULL;
-	inline static std::bitset<65536> *corner_sets = NULL;
+	inline static corner_set *corner_sets = NULL;
 	inline static uint8_t *is_initialized = NULL;
 
-	inline static std::array<std::bitset<65536>, 2> corner_init = {};
+	inline static uint8_t *dirty = NULL;
+	inline static uint16_t *synced = NULL;
+	inline static std::mutex checkpoint_mtx;
+	inline static std::mutex writeback_mtx;
+	inline static std::condition_variable writeback_cv;
+	inline static std::thread writeback;
+	inline static bool writeback_done = false;
+
+	inline static int lease_fd = -1;
+	inline static lease *leases = NULL;
+	inline static lease *seen = NULL;
+	inline static std::atomic<uint8_t> *owned = NULL;
+	inline static std::atomic<uint32_t> *claims = NULL;
+	inline static std::mutex lease_mtx;
+
+	inline static count_entry *counts = NULL;
+	inline static std::array<depth_shard, N_DEPTH_SHARDS> depth_shards = {};
+
+	inline static const unsolved_entry *unsolved_dir = NULL;
+	inline static const uint8_t *unsolved_data = NULL;
+	inline static size_t unsolved_size = 0;
+
+	inline static std::array<corner_set, 2> corner_init = {};
+	inline static std::array<std::vector<ccoord>, 2> corner_inv = {};
 };
 
 #endif
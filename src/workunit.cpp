@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include "workunit.h"
+#include "tables.h"
+
+workunit workunit::from_tracker(size_t start, size_t end) {
+	workunit unit;
+	unit.start = start;
+	unit.end = end;
+
+	for (size_t idx = start; idx < end; idx++) {
+		tracker::handle handle(idx);
+		unit.headers.push_back(*handle.h);
+		auto solutions = tracker::solutions(idx);
+		unit.solutions.insert(unit.solutions.end(), solutions.begin(), solutions.end());
+		unit.unsolved.push_back(*handle.corner_set);
+	}
+
+	return unit;
+}
+
+bool workunit::save(const std::string &path) const {
+	auto tmp = path + ".tmp";
+	std::ofstream f(tmp, std::ofstream::binary);
+
+	file_header h = { MAGIC, start, end, solutions.size() };
+	f.write((const char *) &h, sizeof(h));
+	f.write((const char *) headers.data(), headers.size() * sizeof(tracker::header));
+	f.write((const char *) solutions.data(), solutions.size() * sizeof(tracker::solution));
+
+	// each unsolved set is its count, then dense words or sorted hashes,
+	// as in the unsolved sidecar
+	std::vector<uint16_t> hashes;
+	for (auto &cs : unsolved) {
+		uint32_t count = cs.count();
+		f.write((const char *) &count, sizeof(count));
+		if (count >= corner_set::SPARSE_MAX) {
+			f.write((const char *) cs.words(), corner_set::N_WORDS * sizeof(uint64_t));
+		} else {
+			hashes.clear();
+			cs.for_each([&](uint16_t hash) {
+				hashes.push_back(hash);
+			});
+			f.write((const char *) hashes.data(), count * sizeof(uint16_t));
+		}
+	}
+
+	return f && f.flush() && tables::rename(tmp, path);
+}
+
+bool workunit::load(const std::string &path) {
+	std::ifstream f(path, std::ifstream::binary);
+
+	file_header h;
+	if (!f.read((char *) &h, sizeof(h)) || h.magic != MAGIC ||
+			h.start > h.end || h.end > N_EDGE_INVO) {
+		std::cerr << "invalid work unit " << path << "\n";
+		return false;
+	}
+
+	start = h.start;
+	end = h.end;
+	headers.resize(end - start);
+	solutions.resize(h.n_solutions);
+	unsolved.clear();
+
+	f.read((char *) headers.data(), headers.size() * sizeof(tracker::header));
+	f.read((char *) solutions.data(), solutions.size() * sizeof(tracker::solution));
+
+	// solutions are copied into n_cubes slots per coset
+	size_t n_solved = 0;
+	bool overfull = false;
+	for (auto &h : headers) {
+		n_solved += h.n_solved;
+		overfull |= h.n_solved > h.n_cubes;
+	}
+	if (!f || overfull || n_solved != solutions.size()) {
+		std::cerr << "invalid work unit " << path << "\n";
+		return false;
+	}
+
+	// records are decoded when merged, so their length must fit
+	for (auto &s : solutions) {
+		if (!s.valid() || s.length() > MAX_DEPTH) {
+			std::cerr << "invalid solution in work unit " << path << "\n";
+			return false;
+		}
+	}
+
+	std::vector<uint64_t> words(corner_set::N_WORDS);
+	std::vector<uint16_t> hashes;
+	for (size_t i = 0; i < headers.size(); i++) {
+		uint32_t count;
+		f.read((char *) &count, sizeof(count));
+		if (count >= corner_set::SPARSE_MAX) {
+			f.read((char *) &words[0], words.size() * sizeof(uint64_t));
+			unsolved.push_back(corner_set::from_words(&words[0]));
+		} else {
+			hashes.resize(count);
+			f.read((char *) hashes.data(), count * sizeof(uint16_t));
+			if (std::any_of(hashes.begin(), hashes.end(),
+					[](uint16_t hash) { return hash >= N_CORNER_HASH; })) {
+				std::cerr << "invalid work unit " << path << "\n";
+				return false;
+			}
+			unsolved.push_back(corner_set::from_sorted(hashes.data(), count));
+		}
+		if (!f || unsolved.back().count() != count) {
+			std::cerr << "invalid work unit " << path << "\n";
+			return false;
+		}
+	}
+
+	return true;
+}
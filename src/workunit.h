@@ -0,0 +1,40 @@
+#ifndef INVL_WORKUNIT_H
+#define INVL_WORKUNIT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "corner_set.h"
+#include "tracker.h"
+
+// a range of edge cosets, self-contained for solving on another machine
+// - headers keep their invo.dat offsets, so a result shard maps back
+// - solutions of each coset follow each other, n_solved per coset
+// - the unsolved sets spare the remote node rebuilding them
+
+class workunit {
+	static constexpr uint64_t MAGIC = 0x74696e756b726f77;
+
+    public:
+	uint32_t start = 0;
+	uint32_t end = 0;
+	std::vector<tracker::header> headers;
+	std::vector<tracker::solution> solutions;
+	std::vector<corner_set> unsolved;
+
+	// needs an open tracker, headers and solutions as of now
+	static workunit from_tracker(size_t start, size_t end);
+
+	bool save(const std::string &path) const;
+	bool load(const std::string &path);
+
+    private:
+	struct file_header {
+		uint64_t magic;
+		uint32_t start;
+		uint32_t end;
+		uint64_t n_solutions;
+	};
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include <fstream>
+#include <filesystem>
+#include <CppUTest/TestHarness.h>
+#include "test_util.h"
+#include "test_db.h"
+#include "archive.h"
+
+TEST_GROUP(Archive) {
+	test_db db;
+
+	void teardown() {
+		db.close();
+	}
+};
+
+TEST(Archive, WriteOpen) {
+	// solutions with shared prefixes
+	for (int idx : { 0, 3, 5000, int(N_EDGE_INVO) - 1 }) {
+		moveseq base = t::random_moves(12);
+		for (int i = 0; i < 200; i++) {
+			moveseq moves = base;
+			moves.resize(t::rand(13));
+			for (auto m : t::random_moves(t::rand(9))) {
+				moves.push_back(m);
+			}
+			db.add(idx, moves);
+		}
+	}
+	db.open();
+
+	auto path = (std::filesystem::temp_directory_path() / "invo_archive_test.dat").string();
+	CHECK_TRUE(archive::write(path));
+
+	archive file;
+	CHECK_TRUE(file.open(path));
+	std::filesystem::remove(path);
+
+	CHECK_EQUAL(db.solutions.size(), file.size());
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		CHECK_EQUAL(db.headers[idx].n_solved, file.headers()[idx].n_solved);
+
+		std::vector<moveseq> expect, found;
+		for (auto &s : tracker::solutions(idx)) {
+			expect.push_back(s);
+		}
+		file.for_each(idx, [&](const uint8_t *moves, int len) {
+			found.emplace_back(moves, moves + len);
+		});
+
+		std::sort(expect.begin(), expect.end());
+		CHECK(expect == found);
+	}
+}
+
+TEST(Archive, OpenInvalid) {
+	auto path = (std::filesystem::temp_directory_path() / "invo_archive_bad.dat").string();
+	std::vector<uint8_t> junk(1 << 16, 0x5a);
+	std::ofstream(path, std::ofstream::binary).write((const char *) &junk[0], junk.size());
+
+	archive file;
+	CHECK_FALSE(file.open(path));
+	std::filesystem::remove(path);
+}
@@ -11,10 +11,32 @@ TEST(CornerHash, InvolutionsHashPerfectly) {
 	auto corners = involution::corners();
 
 	for (int parity = 0; parity < 2; parity++) {
-		std::bitset<65536> seen;
+		std::bitset<N_CORNER_HASH> seen;
 		for (auto cc : corners[parity]) {
-			seen.set(corner_hash(cc));
+			auto h = corner_hash(cc);
+			CHECK(h < corners[parity].size());
+			seen.set(h);
 		}
 		CHECK_EQUAL(corners[parity].size(), seen.count());
 	}
 }
+
+TEST(CornerHash, CubeAndBatch) {
+	auto corners = involution::corners();
+
+	for (int parity = 0; parity < 2; parity++) {
+		std::vector<cube> cubes;
+		for (auto cc : corners[parity]) {
+			cube c = cube(cc).setEdgePerm(t::rand(N_EPERM));
+			CHECK_EQUAL(corner_hash(cc), corner_hash(c));
+			cubes.push_back(c.symi(t::rand(N_SYM48)));
+		}
+
+		std::vector<uint16_t> hashes(cubes.size());
+		corner_hash(&cubes[0], cubes.size(), &hashes[0]);
+		for (size_t i = 0; i < cubes.size(); i++) {
+			CHECK_EQUAL(corner_hash(cubes[i]), hashes[i]);
+			CHECK_EQUAL(corner_hash(ccoord(cubes[i])), hashes[i]);
+		}
+	}
+}
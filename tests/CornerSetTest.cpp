@@ -0,0 +1,65 @@
+#include <set>
+#include <CppUTest/TestHarness.h>
+#include "test_util.h"
+#include "corner_set.h"
+
+TEST_GROUP(CornerSet) {
+};
+
+TEST(CornerSet, SetReset) {
+	corner_set cs;
+	std::set<uint16_t> expect;
+
+	for (int i = 0; i < 4000; i++) {
+		uint16_t h = t::rand(N_CORNER_HASH);
+		if (t::rand(3) == 0) {
+			cs.reset(h);
+			expect.erase(h);
+		} else {
+			cs.set(h);
+			expect.insert(h);
+		}
+		CHECK_EQUAL(expect.count(h) != 0, cs.test(h));
+	}
+
+	CHECK_EQUAL(expect.size(), cs.count());
+
+	std::vector<uint16_t> seen;
+	cs.for_each([&](uint16_t h) {
+		seen.push_back(h);
+	});
+	CHECK(std::vector<uint16_t>(expect.begin(), expect.end()) == seen);
+}
+
+TEST(CornerSet, Representation) {
+	corner_set cs;
+	for (int h = 0; h < N_CORNER_HASH; h += 2) {
+		cs.set(h);
+	}
+	CHECK_TRUE(cs.is_dense());
+	CHECK_EQUAL(N_CORNER_HASH / 2, cs.count());
+
+	corner_set copy = corner_set::from_words(cs.words());
+	CHECK_TRUE(copy.is_dense());
+	CHECK_EQUAL(cs.count(), copy.count());
+
+	for (int h = 0; h < N_CORNER_HASH; h++) {
+		CHECK_EQUAL(h % 2 == 0, copy.test(h));
+		if (h >= 400) {
+			CHECK_EQUAL(h % 2 == 0, copy.reset(h));
+		}
+	}
+	CHECK_FALSE(copy.is_dense());
+	CHECK_EQUAL(200, copy.count());
+
+	std::vector<uint16_t> sorted;
+	copy.for_each([&](uint16_t h) {
+		sorted.push_back(h);
+	});
+	corner_set sparse = corner_set::from_sorted(sorted.data(), sorted.size());
+	CHECK_FALSE(sparse.is_dense());
+	CHECK_EQUAL(200, sparse.count());
+	for (int h = 0; h < 400; h++) {
+		CHECK_EQUAL(h % 2 == 0, sparse.test(h));
+	}
+}
@@ -194,6 +194,21 @@ TEST(Cube, GetSet) {
 	CHECK(c == corners.setEdges(edges.getEdges()));
 }
 
+TEST(Cube, Pack) {
+	for (int i = 0; i < 100; i++) {
+		cube c = t::random_cube();
+		CHECK(c == cube::unpack(c.pack()));
+	}
+
+	auto p = cube{}.pack();
+	for (int i = 0; i < 12; i++) {
+		CHECK_EQUAL(i, p[i]);
+	}
+	for (int i = 0; i < 8; i++) {
+		CHECK_EQUAL(i, p[12 + i]);
+	}
+}
+
 TEST(Cube, ToSingmasterReid) {
 	// identity
 	CHECK_EQUAL(
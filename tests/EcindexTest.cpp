@@ -0,0 +1,30 @@
+#include <CppUTest/TestHarness.h>
+#include "test_util.h"
+#include "ecindex.h"
+#include "involution.h"
+
+TEST_GROUP(Ecindex) {
+};
+
+TEST(Ecindex, Build) {
+	auto &edges = involution::edges()[1];
+	std::vector<ecoord> cosets(edges.begin(), edges.begin() + 1000);
+
+	auto entries = ecindex::build(cosets);
+
+	for (int i = 1; i < entries.size(); i++) {
+		CHECK(entries[i - 1] < entries[i]);
+		CHECK_FALSE(entries[i - 1].same_key(entries[i]));
+	}
+
+	std::vector<int> n_identity(cosets.size());
+	for (auto e : entries) {
+		cube c = ecoord{eperm48{e.ep}, eorient{e.eo}};
+		CHECK(c == cube(cosets[e.idx]).symi(e.sym));
+		n_identity[e.idx] += (e.sym == 0);
+	}
+
+	for (auto n : n_identity) {
+		CHECK_EQUAL(1, n);
+	}
+}
@@ -28,3 +28,15 @@ TEST(Eprune, Solve) {
 		CHECK(c.setCornerPerm(0) == cube{});
 	}
 };
+
+TEST(Eprune, Move) {
+	for (int i = 0; i < 100; i++) {
+		ecoord ec = t::random_cube();
+		for (int m = 0; m < N_MOVES; m++) {
+			auto [ ec_m, r_m ] = eprune::move(ec, m);
+			CHECK(cube(ec_m) == cube(ec.move(m)));
+			CHECK(r_m.up == eprune::lookup(ec.move(m)).up);
+			CHECK(r_m.down == eprune::lookup(ec.move(m)).down);
+		}
+	}
+}
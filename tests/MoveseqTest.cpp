@@ -0,0 +1,122 @@
+#include <type_traits>
+#include <vector>
+#include <CppUTest/TestHarness.h>
+#include <CppUTest/TestMemoryAllocator.h>
+#include "test_util.h"
+#include "moveseq.h"
+
+TEST_GROUP(Moveseq) {
+};
+
+TEST(Moveseq, Inline) {
+	CHECK_TRUE(std::is_trivially_copyable_v<moveseq>);
+	CHECK_TRUE(sizeof(moveseq) <= moveseq::CAPACITY + 1);
+
+	// a full sequence and its copy keep their moves within themselves
+	moveseq full = t::random_moves(moveseq::CAPACITY);
+	moveseq copy = full;
+	for (auto *m : { &full, &copy }) {
+		CHECK_TRUE((const void *) m->begin() >= (const void *) m);
+		CHECK_TRUE((const void *) m->end() <= (const void *) (m + 1));
+	}
+	CHECK(copy == full);
+}
+
+#if CPPUTEST_USE_MEM_LEAK_DETECTION
+// counts operator new calls while it is the current new allocator
+struct counting_allocator : TestMemoryAllocator {
+	size_t n = 0;
+
+	counting_allocator() : TestMemoryAllocator("Standard New Allocator", "new", "delete") {
+	}
+
+	char * alloc_memory(size_t size, const char *file, size_t line) override {
+		n++;
+		return TestMemoryAllocator::alloc_memory(size, file, line);
+	}
+};
+
+// allocations made by fn, which must free whatever it allocates
+template<typename F>
+static size_t count_allocations(F fn) {
+	counting_allocator counter;
+	MemoryLeakWarningPlugin::restoreNewDeleteOverloads();
+	setCurrentNewAllocator(&counter);
+	fn();
+	setCurrentNewAllocatorToDefault();
+	MemoryLeakWarningPlugin::saveAndDisableNewDeleteOverloads();
+	return counter.n;
+}
+
+// what the solvers do with their move sequences: push and pop moves,
+// copy out solutions
+template<typename Seq>
+static void solver_work(const moveseq &solution) {
+	Seq moves, copy;
+	for (int i = 0; i < 1000; i++) {
+		moves.clear();
+		for (uint8_t m : solution) {
+			moves.push_back(m);
+		}
+		copy = Seq(moves.begin(), moves.end());
+		while (!copy.empty()) {
+			copy.pop_back();
+		}
+	}
+}
+
+TEST(Moveseq, Allocations) {
+	moveseq solution = t::random_moves(20);
+	size_t before = count_allocations([&] {
+		solver_work<std::vector<uint8_t>>(solution);
+	});
+	size_t after = count_allocations([&] {
+		solver_work<moveseq>(solution);
+		moveseq parsed;
+		moveseq::parse("U R2 F' D1 L B3", parsed);
+		parsed.canonical();
+		solution.canonical();
+	});
+	CHECK_TRUE(before >= 1000);
+	CHECK_EQUAL(0, after);
+}
+#endif
+
+TEST(Moveseq, ParseToString) {
+	moveseq moves, again;
+	CHECK_TRUE(moveseq::parse("U R2 F' D1 L B3", moves));
+	CHECK(moves == moveseq({ 0, 4, 8, 9, 12, 17 }));
+	STRCMP_EQUAL("U1R2F3D1L1B3", moves.to_string().c_str());
+	CHECK_TRUE(moveseq::parse(moves.to_string(), again));
+	CHECK(again == moves);
+}
+
+TEST(Moveseq, ParseTooLong) {
+	std::string s;
+	moveseq moves;
+	for (size_t i = 0; i < moveseq::CAPACITY - 1; i++) {
+		s += "U";
+	}
+	CHECK_TRUE(moveseq::parse(s, moves));
+	CHECK_EQUAL(moveseq::CAPACITY - 1, moves.size());
+
+	s += "R";
+	CHECK_FALSE(moveseq::parse(s, moves));
+}
+
+TEST(Moveseq, Canonical) {
+	CHECK(moveseq{}.canonical() == moveseq{});
+	CHECK(moveseq({ 0, 0 }).canonical() == moveseq({ 1 }));
+	CHECK(moveseq({ 0, 2 }).canonical() == moveseq{});
+	CHECK(moveseq({ 9, 0 }).canonical() == moveseq({ 0, 9 }));
+
+	moveseq full = t::random_moves(moveseq::CAPACITY - 1);
+	CHECK(cube::from_moveseq(full) == cube::from_moveseq(full.canonical()));
+}
+
+TEST(Moveseq, Compare) {
+	CHECK(moveseq({ 0, 3 }) < moveseq({ 0, 4 }));
+	CHECK(moveseq({ 0 }) < moveseq({ 0, 3 }));
+	CHECK_FALSE(moveseq({ 0, 3 }) < moveseq({ 0, 3 }));
+	CHECK_FALSE(moveseq({ 0, 3 }) == moveseq({ 0 }));
+}
@@ -0,0 +1,60 @@
+#include <filesystem>
+#include <CppUTest/TestHarness.h>
+#include "test_util.h"
+#include "test_db.h"
+#include "solution_file.h"
+
+TEST_GROUP(SolutionFile) {
+	test_db db;
+
+	void teardown() {
+		db.close();
+	}
+};
+
+TEST(SolutionFile, WriteOpen) {
+	for (int idx : { 0, 7, 1000, int(N_EDGE_INVO) - 1 }) {
+		for (int i = 0; i < 20; i++) {
+			db.add(idx, t::random_moves(t::rand(MAX_DEPTH + 1)));
+		}
+	}
+	db.open();
+
+	auto path = (std::filesystem::temp_directory_path() / "invo_export_test.dat").string();
+	CHECK_TRUE(solution_file::write(path));
+
+	solution_file file;
+	CHECK_TRUE(file.open(path));
+	std::filesystem::remove(path);
+
+	CHECK_EQUAL(db.solutions.size(), file.size());
+	CHECK_EQUAL(N_EDGE_INVO, file.headers().size());
+
+	for (int idx = 0; idx < N_EDGE_INVO; idx++) {
+		CHECK_EQUAL(db.headers[idx].n_solved, file.headers()[idx].n_solved);
+
+		for (int d = 0; d <= MAX_DEPTH; d++) {
+			std::vector<moveseq> expect;
+			for (auto &s : tracker::solutions(idx)) {
+				if (s.length() == d) {
+					expect.push_back(s);
+				}
+			}
+
+			auto records = file.solutions(d, idx);
+			CHECK_EQUAL(expect.size(), records.size());
+			for (size_t i = 0; i < records.size(); i++) {
+				CHECK(expect[i] == moveseq(records[i]));
+			}
+		}
+	}
+
+	size_t total = 0;
+	for (int d = 0; d <= MAX_DEPTH; d++) {
+		for (auto &s : file.solutions(d)) {
+			CHECK_EQUAL(d, s.length());
+			total++;
+		}
+	}
+	CHECK_EQUAL(db.solutions.size(), total);
+}
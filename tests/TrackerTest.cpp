@@ -35,3 +35,21 @@ TEST(Tracker, SolutionConvert) {
 		}
 	}
 }
+
+TEST(Tracker, SolutionDecode) {
+	for (int i = 0; i < 100; i++) {
+		moveseq moves = t::random_canonical_moves(t::rand(MAX_DEPTH + 1));
+		tracker::solution sol = moves;
+
+		uint8_t decoded[MAX_DEPTH];
+		int len = sol.decode(decoded);
+		CHECK(moves == moveseq(decoded, decoded + len));
+	}
+}
+
+TEST(Tracker, SolutionToCube) {
+	for (int i = 0; i < 100; i++) {
+		tracker::solution sol = t::random_moves(t::rand(MAX_DEPTH + 1));
+		CHECK(cube::from_moveseq(moveseq(sol)) == sol.to_cube());
+	}
+}
@@ -0,0 +1,129 @@
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <CppUTest/TestHarness.h>
+#include "test_util.h"
+#include "workunit.h"
+
+TEST_GROUP(Workunit) {
+};
+
+TEST(Workunit, SaveLoad) {
+	workunit unit;
+	unit.start = 100;
+	unit.end = 103;
+
+	for (int i = 0; i < 3; i++) {
+		tracker::header h = {};
+		h.offset = 1000 * i;
+		h.ep = t::rand(1 << 30);
+		h.eo = t::rand(1 << 11);
+		h.n_cubes = 500;
+		h.n_solved = i;
+		h.proven_min = 16 + i;
+		unit.headers.push_back(h);
+
+		for (int j = 0; j < i; j++) {
+			unit.solutions.push_back(t::random_moves(15 + j));
+		}
+
+		// empty, sparse and dense unsolved sets
+		corner_set cs;
+		for (int n = 0; n < i * corner_set::SPARSE_MAX * 3 / 4; n++) {
+			cs.set(t::rand(N_CORNER_HASH));
+		}
+		unit.unsolved.push_back(cs);
+	}
+
+	auto path = (std::filesystem::temp_directory_path() / "invo_unit_test.dat").string();
+	CHECK_TRUE(unit.save(path));
+
+	workunit loaded;
+	CHECK_TRUE(loaded.load(path));
+	std::filesystem::remove(path);
+
+	CHECK_EQUAL(unit.start, loaded.start);
+	CHECK_EQUAL(unit.end, loaded.end);
+	CHECK_EQUAL(0, memcmp(&unit.headers[0], &loaded.headers[0], 3 * sizeof(tracker::header)));
+
+	CHECK_EQUAL(unit.solutions.size(), loaded.solutions.size());
+	for (size_t i = 0; i < unit.solutions.size(); i++) {
+		CHECK(moveseq(unit.solutions[i]) == moveseq(loaded.solutions[i]));
+	}
+
+	for (int i = 0; i < 3; i++) {
+		CHECK_EQUAL(unit.unsolved[i].count(), loaded.unsolved[i].count());
+		for (int h = 0; h < N_CORNER_HASH; h++) {
+			CHECK_EQUAL(unit.unsolved[i].test(h), loaded.unsolved[i].test(h));
+		}
+	}
+}
+
+TEST(Workunit, LoadInvalid) {
+	auto path = (std::filesystem::temp_directory_path() / "invo_unit_bad.dat").string();
+	std::ofstream(path) << "not a work unit";
+
+	workunit unit;
+	CHECK_FALSE(unit.load(path));
+	std::filesystem::remove(path);
+}
+
+TEST(Workunit, LoadInvalidSolution) {
+	workunit unit;
+	unit.start = 10;
+	unit.end = 11;
+
+	tracker::header h = {};
+	h.n_cubes = 100;
+	h.n_solved = 1;
+	unit.headers.push_back(h);
+	unit.unsolved.emplace_back();
+
+	// valid, but longer than any decode buffer
+	tracker::solution s;
+	s.info = 0b10000000 | 31;
+	unit.solutions.push_back(s);
+
+	auto path = (std::filesystem::temp_directory_path() / "invo_unit_long.dat").string();
+	CHECK_TRUE(unit.save(path));
+
+	workunit loaded;
+	CHECK_FALSE(loaded.load(path));
+	std::filesystem::remove(path);
+}
+
+TEST(Workunit, LoadInvalidHeader) {
+	auto path = (std::filesystem::temp_directory_path() / "invo_unit_header.dat").string();
+
+	auto make = [](int n_cubes, uint16_t hash) {
+		workunit unit;
+		unit.start = 10;
+		unit.end = 11;
+
+		tracker::header h = {};
+		h.n_cubes = n_cubes;
+		h.n_solved = 2;
+		unit.headers.push_back(h);
+		unit.solutions.push_back(t::random_moves(10));
+		unit.solutions.push_back(t::random_moves(11));
+
+		corner_set cs;
+		cs.set(hash);
+		unit.unsolved.push_back(cs);
+		return unit;
+	};
+
+	workunit loaded;
+	CHECK_TRUE(make(2, N_CORNER_HASH - 1).save(path));
+	CHECK_TRUE(loaded.load(path));
+
+	// more solutions than slots
+	CHECK_TRUE(make(1, 0).save(path));
+	CHECK_FALSE(loaded.load(path));
+
+	// unsolved hash out of range
+	CHECK_TRUE(make(2, N_CORNER_HASH).save(path));
+	CHECK_FALSE(loaded.load(path));
+
+	std::filesystem::remove(path);
+}
@@ -0,0 +1,32 @@
+#ifndef INVL_TEST_DB_H
+#define INVL_TEST_DB_H
+
+#include <algorithm>
+#include <vector>
+#include "tracker.h"
+
+// an in-memory database of a few solved cosets, otherwise empty
+// - add solutions in coset order, then open()
+// - close() in teardown frees what open() allocated
+struct test_db {
+	std::vector<tracker::header> headers = std::vector<tracker::header>(N_EDGE_INVO);
+	std::vector<tracker::solution> solutions;
+
+	void add(int idx, const moveseq &moves) {
+		auto &h = headers[idx];
+		solutions.push_back(moves);
+		h.n_solved++;
+		h.n_cubes = std::max(h.n_cubes, h.n_solved);
+		h.n_length[solutions.back().length()]++;
+	}
+
+	void open() {
+		tracker::open_memory(0, headers, solutions, {});
+	}
+
+	void close() {
+		tracker::close_memory();
+	}
+};
+
+#endif
@@ -31,6 +31,21 @@ struct t {
 		return moves;
 	}
 
+	// no two moves on the same axis, so canonical() leaves them as they are
+	static moveseq random_canonical_moves(int count) {
+		moveseq moves;
+		int last_axis = -1;
+		for (int i = 0; i < count; i++) {
+			int axis;
+			do {
+				axis = rand(6);
+			} while (axis % 3 == last_axis % 3);
+			last_axis = axis;
+			moves.push_back(axis * 3 + rand(3));
+		}
+		return moves;
+	}
+
     private:
 	static std::mt19937 rng;
 };